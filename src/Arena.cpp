@@ -0,0 +1,68 @@
+#include "Arena.hpp"
+
+#include <new>
+
+Arena::Arena(std::size_t capacity) : block(capacity), pool(&block) {}
+
+std::pmr::memory_resource* Arena::get() {
+    return &pool;
+}
+
+void Arena::reset() {
+    pool.release();
+    block.reset();
+}
+
+std::size_t Arena::getCapacity() const {
+    return block.getCapacity();
+}
+
+Arena::Block::Block(std::size_t capacity) : capacity(capacity) {
+    memory.reset(new std::max_align_t[(capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]);
+}
+
+Arena::Block::~Block() {
+    reset();
+}
+
+void Arena::Block::reset() {
+    for (const Overflow& overflow : overflows)
+        ::operator delete(overflow.p, overflow.bytes, std::align_val_t(overflow.alignment));
+    overflows.clear();
+
+    // grow to fit everything the last run needed, with some room to spare
+    if (overflowBytes > 0) {
+        capacity = (used + overflowBytes) * 5 / 4;
+        memory.reset(new std::max_align_t[(capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]);
+        overflowBytes = 0;
+    }
+    used = 0;
+}
+
+std::size_t Arena::Block::getCapacity() const {
+    return capacity;
+}
+
+void* Arena::Block::do_allocate(std::size_t bytes, std::size_t alignment) {
+    char* base = reinterpret_cast<char*>(memory.get());
+    std::size_t start = (used + alignment - 1) / alignment * alignment;
+    if (start + bytes <= capacity) {
+        used = start + bytes;
+        return base + start;
+    }
+
+    overflows.push_back(Overflow {::operator new(bytes, std::align_val_t(alignment)), bytes, alignment});
+    overflowBytes += bytes + alignment;
+    return overflows.back().p;
+}
+
+void Arena::Block::do_deallocate(void* p, std::size_t bytes, std::size_t) {
+    // only the latest allocation can be handed back (a vector growing over and over), the rest waits for reset
+    char* base = reinterpret_cast<char*>(memory.get());
+    if (static_cast<char*>(p) + bytes == base + used)
+        used = static_cast<char*>(p) - base;
+}
+
+bool Arena::Block::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
@@ -0,0 +1,61 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// scratch memory for one run of a generator (stacks, frontiers, set tables), everything is thrown away at once by
+// reset between runs
+//
+// allocations are carved out of one block, small ones go through a pool first so freed nodes (ellers' set tables
+// come and go every row) are reused within the run. whatever doesn't fit the block comes from the heap and the block
+// grows to fit it at the next reset, so after the first of a series of similar runs nothing allocates anymore
+//
+// not thread safe, every solver has its own
+class Arena {
+public:
+    explicit Arena(std::size_t capacity = 1 << 16);
+
+    // resource for the std::pmr containers of the current run
+    std::pmr::memory_resource* get();
+
+    // frees everything handed out since the last reset, any containers using the arena must be gone by then
+    void reset();
+
+    std::size_t getCapacity() const;
+
+private:
+    class Block : public std::pmr::memory_resource {
+    public:
+        explicit Block(std::size_t capacity);
+        ~Block();
+
+        void reset();
+        std::size_t getCapacity() const;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* p, std::size_t bytes, std::size_t) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::unique_ptr<std::max_align_t[]> memory;
+        std::size_t capacity;
+        std::size_t used = 0;
+
+        // allocations that didn't fit, freed at the next reset
+        struct Overflow {
+            void* p;
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+        std::vector<Overflow> overflows;
+        std::size_t overflowBytes = 0;
+    };
+
+    Block block;
+    std::pmr::unsynchronized_pool_resource pool;
+};
+
+#endif /* ARENA_HPP */
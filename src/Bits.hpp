@@ -0,0 +1,37 @@
+#ifndef BITS_HPP
+#define BITS_HPP
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// portable wrappers around the bit scanning instructions (std::popcount and friends are c++20)
+namespace bits {
+    inline int popcount(std::uint64_t x) {
+#ifdef _MSC_VER
+        return (int) __popcnt64(x);
+#else
+        return __builtin_popcountll(x);
+#endif
+    }
+
+    // index of the lowest set bit, x must not be 0
+    inline int countTrailingZeros(std::uint64_t x) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return (int) index;
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    // mask with the lowest n bits set (n in [0, 64])
+    inline std::uint64_t lowMask(int n) {
+        return (n >= 64) ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1;
+    }
+}
+
+#endif /* BITS_HPP */
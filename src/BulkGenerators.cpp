@@ -0,0 +1,179 @@
+#include "BulkGenerators.hpp"
+#include "Bits.hpp"
+#include "Random.hpp"
+#include "TextExport.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace bulk {
+    // invisible namespace for "private" functions
+    namespace {
+        // counts what is written to it and drops it, so the text export can be timed without the disk
+        class CountingBuffer : public std::streambuf {
+        public:
+            std::uint64_t count = 0;
+
+        protected:
+            std::streamsize xsputn(const char*, std::streamsize n) override {
+                count += n;
+                return n;
+            }
+
+            int overflow(int c) override {
+                count++;
+                return c;
+            }
+        };
+
+        // calls carve for every row, the rows are split into one contiguous band per thread
+        // a row may only write its own right words and the down words of the row above it
+        template <class F>
+        void forEachRow(int rows, int threads, F carve) {
+            threads = std::max(1, std::min(threads, rows));
+            int bandRows = (rows + threads - 1) / threads;
+
+            auto band = [&](int t) {
+                for (int row = t * bandRows; row < std::min(rows, (t + 1) * bandRows); row++)
+                    carve(row);
+            };
+
+            std::vector<std::thread> workers;
+            for (int t = 1; t < threads; t++)
+                workers.emplace_back(band, t);
+            band(0);
+            for (std::thread& worker : workers)
+                worker.join();
+        }
+
+        // cells of the word that exist, and the ones of those that have a neighbor to the right
+        std::uint64_t cellMask(int cols, int word) {
+            return bits::lowMask(cols - word * 64);
+        }
+
+        std::uint64_t rightMask(int cols, int word) {
+            return bits::lowMask(cols - 1 - word * 64);
+        }
+
+        // drops the passages of a row (to the right and up into the row above) that touch cells outside the mask,
+        // whole words at a time so masked out cells cost nothing per cell
+        void clipRow(const Maze& maze, int row, std::uint64_t* right, std::uint64_t* up) {
+            const std::uint64_t* active = maze.getMaskWords(row);
+            if (!active)
+                return;
+
+            int words = maze.getWordsPerRow();
+            for (int word = 0; word < words; word++) {
+                std::uint64_t next = word < words - 1 ? active[word + 1] << 63 : 0;
+                right[word] &= active[word] & ((active[word] >> 1) | next);
+                if (up)
+                    up[word] &= active[word] & maze.getMaskWords(row - 1)[word];
+            }
+        }
+    }
+
+    // see header
+    void binaryTree(Maze& maze, std::uint64_t seed, int threads) {
+        int rows = maze.getSize().x;
+        int cols = maze.getSize().y;
+        int words = maze.getWordsPerRow();
+
+        forEachRow(rows, threads, [&](int row) {
+            std::uint64_t state = rnd::hashCombine(seed, row);
+            std::uint64_t* right = maze.getRightWords(row);
+
+            for (int word = 0; word < words; word++) {
+                // the top row can only go right, everywhere else a random bit picks right (1) or up (0)
+                if (row == 0) {
+                    right[word] = rightMask(cols, word);
+                    continue;
+                }
+
+                right[word] = rnd::splitmix64(state) & rightMask(cols, word);
+                maze.getDownWords(row - 1)[word] = cellMask(cols, word) & ~right[word];
+            }
+
+            if (row == rows - 1)
+                std::fill(maze.getDownWords(row), maze.getDownWords(row) + words, 0);
+            clipRow(maze, row, right, row > 0 ? maze.getDownWords(row - 1) : nullptr);
+        });
+    }
+
+    // see header
+    void sidewinder(Maze& maze, std::uint64_t seed, int threads) {
+        int rows = maze.getSize().x;
+        int cols = maze.getSize().y;
+        int words = maze.getWordsPerRow();
+
+        forEachRow(rows, threads, [&](int row) {
+            std::uint64_t state = rnd::hashCombine(seed, row);
+            std::uint64_t* right = maze.getRightWords(row);
+
+            // the top row is a single run with nowhere to go up to
+            if (row == 0) {
+                for (int word = 0; word < words; word++)
+                    right[word] = rightMask(cols, word);
+            }
+            else {
+                std::uint64_t* up = maze.getDownWords(row - 1);
+                for (int word = 0; word < words; word++) {
+                    right[word] = rnd::splitmix64(state) & rightMask(cols, word);
+                    up[word] = 0;
+                }
+
+                // every cell without a passage to the right closes a run, which carves up from one of its cells
+                int runStart = 0;
+                for (int word = 0; word < words; word++) {
+                    std::uint64_t ends = cellMask(cols, word) & ~right[word];
+                    while (ends) {
+                        int end = word * 64 + bits::countTrailingZeros(ends);
+                        int cell = runStart + rnd::bounded(rnd::splitmix64(state), end - runStart + 1);
+                        up[cell / 64] |= std::uint64_t(1) << (cell % 64);
+
+                        runStart = end + 1;
+                        ends &= ends - 1;
+                    }
+                }
+            }
+
+            if (row == rows - 1)
+                std::fill(maze.getDownWords(row), maze.getDownWords(row) + words, 0);
+            clipRow(maze, row, right, row > 0 ? maze.getDownWords(row - 1) : nullptr);
+        });
+    }
+
+    // see header
+    void benchmark(int size, int threads) {
+        Maze maze(size, size);
+        double cells = (double) size * size;
+
+        // both generators overwrite every passage word, so the same maze can be reused without a reset
+        auto run = [&](const char* name, void (*algo)(Maze&, std::uint64_t, int)) {
+            double best = 0;
+            for (int i = 0; i < 5; i++) {
+                auto start = std::chrono::steady_clock::now();
+                algo(maze, i, threads);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                best = std::max(best, cells / seconds);
+            }
+            std::cout << name << ": " << best / 1e9 << " billion cells per second" << std::endl;
+        };
+
+        std::cout << "Generating " << size << "x" << size << " mazes on " << threads << " threads" << std::endl;
+        run("Binary Tree", &binaryTree);
+        run("Sidewinder", &sidewinder);
+
+        // the exporter only has to keep up with the disk it writes to
+        CountingBuffer sink;
+        std::ostream os(&sink);
+        TextExporter exporter(TextExporter::Style::Unicode);
+        auto start = std::chrono::steady_clock::now();
+        exporter.write(os, maze);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Text export: " << sink.count / seconds / 1e6 << " MB per second (" << sink.count / 1e6 << " MB)" << std::endl;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef BULK_GENERATORS_HPP
+#define BULK_GENERATORS_HPP
+
+#include "Maze.hpp"
+
+#include <cstdint>
+
+// generators where every row can be carved on its own, so instead of going through toggleWall one cell at a time
+// they write random bitmasks straight into the maze's passage words (64 cells at a time) and split the rows
+// between threads. the maze must be freshly initialized and the result only depends on the seed, not the threads
+//
+// on masked mazes the passages leaving the mask are dropped, which can leave the maze in pieces (see
+// MazeSolver::fitToMask)
+namespace bulk {
+    // every cell carves either up or right (the top row and right column are corridors)
+    void binaryTree(Maze& maze, std::uint64_t seed, int threads);
+
+    // every row is split into runs of cells joined to the right and every run carves up from one random cell
+    void sidewinder(Maze& maze, std::uint64_t seed, int threads);
+
+    // generates a size x size maze with both algorithms a few times and prints cells per second, then how fast the
+    // last one is exported as text
+    void benchmark(int size, int threads);
+}
+
+#endif /* BULK_GENERATORS_HPP */
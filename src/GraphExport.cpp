@@ -0,0 +1,184 @@
+#include "GraphExport.hpp"
+#include "Bits.hpp"
+
+// markers in nodeIds for cells that aren't nodes (yet)
+constexpr std::uint32_t unvisited = 0xFFFFFFFF;
+constexpr std::uint32_t corridor = 0xFFFFFFFE;
+constexpr std::uint32_t keptCell = 0xFFFFFFFD;
+
+// exits of a cell as bit flags
+constexpr std::uint32_t exitUp = 1;
+constexpr std::uint32_t exitDown = 2;
+constexpr std::uint32_t exitLeft = 4;
+constexpr std::uint32_t exitRight = 8;
+
+// invisible namespace for "private" functions
+namespace {
+    std::uint32_t getBit(const std::uint64_t* words, int col) {
+        return (words[col / 64] >> (col % 64)) & 1;
+    }
+
+    // the passages out of every cell of a row, read straight from the bitmaps
+    void loadExits(const Maze& maze, int row, std::uint8_t* exits) {
+        const std::uint64_t* right = maze.getRightWords(row);
+        const std::uint64_t* down = maze.getDownWords(row);
+        const std::uint64_t* up = row > 0 ? maze.getDownWords(row - 1) : nullptr;
+
+        int cols = maze.getSize().y;
+        std::uint32_t left = 0;
+        for (int col = 0; col < cols; col++) {
+            std::uint32_t open = getBit(right, col);
+            exits[col] = (std::uint8_t) ((up ? getBit(up, col) * exitUp : 0) | getBit(down, col) * exitDown |
+                                         left * exitLeft | open * exitRight);
+            left = open;
+        }
+    }
+
+    // swaps up with down and left with right
+    std::uint32_t getOpposite(std::uint32_t exit) {
+        return ((exit & (exitUp | exitLeft)) << 1) | ((exit & (exitDown | exitRight)) >> 1);
+    }
+
+    std::uint32_t getNeighbour(std::uint32_t cell, std::uint32_t exit, int cols) {
+        switch (exit) {
+            case exitUp:
+                return cell - cols;
+            case exitDown:
+                return cell + cols;
+            case exitLeft:
+                return cell - 1;
+            default:
+                return cell + 1;
+        }
+    }
+
+    void appendWords(std::string& out, const std::vector<std::uint32_t>& words) {
+        out.append(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(std::uint32_t));
+    }
+}
+
+std::size_t MazeGraph::getNodeCount() const {
+    return nodeCells.size();
+}
+
+std::size_t MazeGraph::getEdgeCount() const {
+    return targets.size();
+}
+
+void GraphExporter::keep(sf::Vector2u cell) {
+    kept.push_back(cell);
+}
+
+void GraphExporter::clearKept() {
+    kept.clear();
+}
+
+void GraphExporter::setCorridors(bool corridors) {
+    this->corridors = corridors;
+}
+
+void GraphExporter::walk(std::uint32_t cell, std::uint32_t exit) {
+    if (corridors)
+        graph.corridorOffsets.push_back((std::uint32_t) graph.corridorCells.size());
+
+    std::uint32_t steps = 1;
+    cell = getNeighbour(cell, exit, graph.cols);
+
+    // every cell in a corridor has exactly two exits, so there's only ever one way on
+    while (nodeIds[cell] >= keptCell) {
+        nodeIds[cell] = corridor;
+        if (corridors)
+            graph.corridorCells.push_back(cell);
+
+        exit = exits[cell] & ~getOpposite(exit);
+        cell = getNeighbour(cell, exit, graph.cols);
+        steps++;
+    }
+
+    graph.targets.push_back(nodeIds[cell]);
+    graph.weights.push_back(steps);
+}
+
+const MazeGraph& GraphExporter::build(const Maze& maze) {
+    graph.rows = maze.getSize().x;
+    graph.cols = maze.getSize().y;
+    std::uint32_t cells = (std::uint32_t) graph.rows * graph.cols;
+
+    graph.offsets.clear();
+    graph.targets.clear();
+    graph.weights.clear();
+    graph.nodeCells.clear();
+    graph.corridorOffsets.clear();
+    graph.corridorCells.clear();
+
+    exits.resize(cells);
+    for (int row = 0; row < graph.rows; row++)
+        loadExits(maze, row, &exits[(std::size_t) row * graph.cols]);
+
+    nodeIds.assign(cells, unvisited);
+    for (const sf::Vector2u& cell : kept)
+        if (cell.x < (unsigned int) graph.rows && cell.y < (unsigned int) graph.cols)
+            nodeIds[cell.x * graph.cols + cell.y] = keptCell;
+
+    // everything that isn't the middle of a corridor is a node
+    for (std::uint32_t cell = 0; cell < cells; cell++) {
+        if (nodeIds[cell] == keptCell || bits::popcount(exits[cell]) != 2) {
+            nodeIds[cell] = (std::uint32_t) graph.nodeCells.size();
+            graph.nodeCells.push_back(cell);
+        }
+    }
+
+    std::size_t node = 0;
+    std::uint32_t scan = 0;
+    while (true) {
+        for (; node < graph.nodeCells.size(); node++) {
+            graph.offsets.push_back((std::uint32_t) graph.targets.size());
+
+            std::uint32_t open = exits[graph.nodeCells[node]];
+            while (open) {
+                std::uint32_t exit = open & (0 - open);
+                walk(graph.nodeCells[node], exit);
+                open &= open - 1;
+            }
+        }
+
+        // a loop of corridor cells that never touches a node (only in mazes that aren't perfect) still needs one
+        while (scan < cells && nodeIds[scan] != unvisited)
+            scan++;
+        if (scan == cells)
+            break;
+
+        nodeIds[scan] = (std::uint32_t) graph.nodeCells.size();
+        graph.nodeCells.push_back(scan);
+    }
+
+    graph.offsets.push_back((std::uint32_t) graph.targets.size());
+    if (corridors)
+        graph.corridorOffsets.push_back((std::uint32_t) graph.corridorCells.size());
+
+    return graph;
+}
+
+void GraphExporter::append(std::string& out, const Maze& maze) {
+    build(maze);
+
+    std::uint32_t header[5] = {(std::uint32_t) graph.rows, (std::uint32_t) graph.cols, (std::uint32_t) graph.getNodeCount(),
+                               (std::uint32_t) graph.getEdgeCount(), corridors ? 1u : 0u};
+    out.append("MGRF", 4);
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+
+    appendWords(out, graph.offsets);
+    appendWords(out, graph.targets);
+    appendWords(out, graph.weights);
+    appendWords(out, graph.nodeCells);
+    if (corridors) {
+        appendWords(out, graph.corridorOffsets);
+        appendWords(out, graph.corridorCells);
+    }
+}
+
+void GraphExporter::write(std::ostream& os, const Maze& maze) {
+    buffer.clear();
+    append(buffer, maze);
+    os.write(buffer.data(), buffer.size());
+}
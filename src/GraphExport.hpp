@@ -0,0 +1,74 @@
+#ifndef GRAPH_EXPORT_HPP
+#define GRAPH_EXPORT_HPP
+
+#include "Maze.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// adjacency of a maze as a compressed sparse row graph with every corridor (chain of cells with exactly two passages)
+// contracted into a single weighted edge, so only junctions, dead ends and kept cells are nodes
+//
+// cells are numbered row * cols + col, every passage is stored in both directions
+struct MazeGraph {
+    int rows = 0;
+    int cols = 0;
+
+    // the edges of node n are offsets[n] to offsets[n + 1] in targets and weights
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> targets;
+
+    // number of steps between the two cells of an edge
+    std::vector<std::uint32_t> weights;
+
+    // the cell of every node
+    std::vector<std::uint32_t> nodeCells;
+
+    // the corridor cells of edge e in walking order are corridorOffsets[e] to corridorOffsets[e + 1] in corridorCells
+    // (only filled in when corridors are kept, see GraphExporter::setCorridors)
+    std::vector<std::uint32_t> corridorOffsets;
+    std::vector<std::uint32_t> corridorCells;
+
+    std::size_t getNodeCount() const;
+    std::size_t getEdgeCount() const;
+};
+
+// builds the contracted graph of a maze, the buffers are reused between mazes
+class GraphExporter {
+public:
+    // cells that always become nodes, even in the middle of a corridor (the start and goal of a query for example)
+    void keep(sf::Vector2u cell);
+    void clearKept();
+
+    // whether the cells inside every corridor are recorded as well (on by default)
+    void setCorridors(bool corridors);
+
+    const MazeGraph& build(const Maze& maze);
+
+    // appends the graph in its binary form: "MGRF", then rows, cols, nodes, edges and a flag that is 1 when the
+    // corridor cells are included as 32 bit unsigned integers, then offsets, targets, weights and node cells and
+    // if included the corridor offsets and corridor cells (everything 32 bit unsigned in host byte order)
+    void append(std::string& out, const Maze& maze);
+
+    void write(std::ostream& os, const Maze& maze);
+
+private:
+    // follows the corridor leaving the node's cell through exit and adds the edge to the node it ends at
+    void walk(std::uint32_t cell, std::uint32_t exit);
+
+    MazeGraph graph;
+    bool corridors = true;
+    std::vector<sf::Vector2u> kept;
+
+    // passages out of every cell as bit flags
+    std::vector<std::uint8_t> exits;
+
+    // node of every cell, or a marker for cells that aren't nodes
+    std::vector<std::uint32_t> nodeIds;
+    std::string buffer;
+};
+
+#endif /* GRAPH_EXPORT_HPP */
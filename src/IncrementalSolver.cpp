@@ -0,0 +1,306 @@
+#include "IncrementalSolver.hpp"
+#include "Render.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const Maze::Direction directions[] {Maze::Direction::Up,
+                                           Maze::Direction::Down,
+                                           Maze::Direction::Left,
+                                           Maze::Direction::Right};
+
+IncrementalSolver::IncrementalSolver(Maze& maze, sf::Vector2u start, sf::Vector2u goal) : maze(maze) {
+    reset(start, goal);
+}
+
+void IncrementalSolver::reset(sf::Vector2u start, sf::Vector2u goal) {
+    rows = maze.getSize().x;
+    cols = maze.getSize().y;
+    this->start = start.x * cols + start.y;
+    this->goal = goal.x * cols + goal.y;
+
+    path.clear();
+    pathIndex.assign(rows * cols, -1);
+    stamp.assign(rows * cols, 0);
+    parent.assign(rows * cols, -1);
+    currentStamp = 0;
+
+    solve();
+}
+
+int IncrementalSolver::neighbor(int cell, Maze::Direction dir) const {
+    int row = cell / cols;
+    int col = cell % cols;
+    switch (dir) {
+        case Maze::Direction::Up:
+            return (row == 0) ? -1 : cell - cols;
+        case Maze::Direction::Down:
+            return (row == rows - 1) ? -1 : cell + cols;
+        case Maze::Direction::Left:
+            return (col == 0) ? -1 : cell - 1;
+        case Maze::Direction::Right:
+            return (col == cols - 1) ? -1 : cell + 1;
+        default:
+            return -1;
+    }
+}
+
+bool IncrementalSolver::isOpen(int cell, Maze::Direction dir) const {
+    return maze.isOpen(cell / cols, cell % cols, dir);
+}
+
+void IncrementalSolver::newSearch() {
+    // only clear the stamps when the counter wraps around
+    if (++currentStamp == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        currentStamp = 1;
+    }
+    queue.clear();
+}
+
+bool IncrementalSolver::isMarked(int cell) const {
+    return stamp[cell] == currentStamp;
+}
+
+void IncrementalSolver::mark(int cell, int from) {
+    stamp[cell] = currentStamp;
+    parent[cell] = from;
+}
+
+// replaces path[from, to) with cells, only the part of the path that moved gets reindexed
+void IncrementalSolver::splice(int from, int to, const std::vector<int>& cells) {
+    for (int i = from; i < to; i++)
+        pathIndex[path[i]] = -1;
+
+    int end = (int) path.size();
+    if ((int) cells.size() == to - from) {
+        std::copy(cells.begin(), cells.end(), path.begin() + from);
+        end = to;
+    }
+    else {
+        path.erase(path.begin() + from, path.begin() + to);
+        path.insert(path.begin() + from, cells.begin(), cells.end());
+        end = (int) path.size();
+    }
+
+    for (int i = from; i < end; i++)
+        pathIndex[path[i]] = i;
+}
+
+void IncrementalSolver::solve() {
+    fullSolves++;
+
+    for (int cell : path)
+        pathIndex[cell] = -1;
+    path.clear();
+    connected = false;
+    reachDirty = false;
+
+    // plain breadth first search, if the goal isn't found the marks are left as the set of cells reachable from the start
+    newSearch();
+    mark(start, -1);
+    queue.push_back(start);
+    for (std::size_t head = 0; head < queue.size() && !connected; head++) {
+        int cell = queue[head];
+        if (cell == goal) {
+            connected = true;
+            break;
+        }
+
+        for (Maze::Direction dir : directions) {
+            int next = neighbor(cell, dir);
+            if (next >= 0 && !isMarked(next) && isOpen(cell, dir)) {
+                mark(next, cell);
+                queue.push_back(next);
+            }
+        }
+    }
+
+    if (connected) {
+        detour.clear();
+        for (int cell = goal; cell != -1; cell = parent[cell])
+            detour.push_back(cell);
+        std::reverse(detour.begin(), detour.end());
+        splice(0, 0, detour);
+    }
+}
+
+// a new passage between two cells on the path lets us skip everything in between
+void IncrementalSolver::shortcut(int a, int b) {
+    int ia = pathIndex[a];
+    int ib = pathIndex[b];
+    if (ia < 0 || ib < 0)
+        return;
+
+    if (ia > ib)
+        std::swap(ia, ib);
+
+    if (ib - ia > 1) {
+        detour.clear();
+        splice(ia + 1, ib, detour);
+    }
+}
+
+// the wall between path[i] and path[i + 1] closed, look for the closest way back onto the second half of the path
+void IncrementalSolver::repair(int a, int b) {
+    int cut = std::min(pathIndex[a], pathIndex[b]);
+    int found = -1;
+
+    newSearch();
+    mark(path[cut], -1);
+    queue.push_back(path[cut]);
+    for (std::size_t head = 0; head < queue.size() && found < 0; head++) {
+        // the detour is too far away to be worth it, a full search is cheaper than carrying on
+        if ((int) queue.size() > repairBudget) {
+            solve();
+            return;
+        }
+
+        int cell = queue[head];
+        for (Maze::Direction dir : directions) {
+            int next = neighbor(cell, dir);
+            if (next < 0 || isMarked(next) || !isOpen(cell, dir))
+                continue;
+
+            mark(next, cell);
+            if (pathIndex[next] > cut) {
+                found = next;
+                break;
+            }
+            queue.push_back(next);
+        }
+    }
+
+    // the start can't reach the second half of the path anymore (the usual case in a perfect maze). the search ran
+    // out within the budget from a cell the start is joined to, so its marks are exactly the cells a full search
+    // would leave as reachable, only rooted at the cut. root them at the start instead so extend can walk back to it
+    if (found < 0) {
+        for (int i = 0; i < (int) path.size(); i++) {
+            if (i <= cut)
+                parent[path[i]] = i > 0 ? path[i - 1] : -1;
+            pathIndex[path[i]] = -1;
+        }
+        path.clear();
+        connected = false;
+        reachDirty = false;
+        return;
+    }
+
+    // walk back until the detour meets the first half of the path (it may rejoin it earlier than the cut)
+    detour.clear();
+    int cell = parent[found];
+    while (pathIndex[cell] < 0) {
+        detour.push_back(cell);
+        cell = parent[cell];
+    }
+    std::reverse(detour.begin(), detour.end());
+
+    splice(pathIndex[cell] + 1, pathIndex[found], detour);
+}
+
+// a wall opened from the reachable area into an unreached cell, keep the search going from there
+void IncrementalSolver::extend(int from, int to) {
+    queue.clear();
+    mark(to, from);
+    queue.push_back(to);
+    for (std::size_t head = 0; head < queue.size(); head++) {
+        int cell = queue[head];
+        if (cell == goal) {
+            connected = true;
+            detour.clear();
+            for (int c = goal; c != -1; c = parent[c])
+                detour.push_back(c);
+            std::reverse(detour.begin(), detour.end());
+            splice(0, 0, detour);
+            return;
+        }
+
+        for (Maze::Direction dir : directions) {
+            int next = neighbor(cell, dir);
+            if (next >= 0 && !isMarked(next) && isOpen(cell, dir)) {
+                mark(next, cell);
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+void IncrementalSolver::update(int a, int b, Maze::Direction dir) {
+    // walls on the edge of the maze don't lead anywhere
+    if (b < 0)
+        return;
+
+    bool opened = isOpen(a, dir);
+    if (connected) {
+        if (opened)
+            shortcut(a, b);
+        else if (pathIndex[a] >= 0 && pathIndex[b] >= 0 && std::abs(pathIndex[a] - pathIndex[b]) == 1)
+            repair(a, b);
+    }
+    else if (opened) {
+        // the marks are a superset of the reachable cells even when dirty, so a passage between two unmarked cells can't matter
+        if (reachDirty && (isMarked(a) || isMarked(b)))
+            solve();
+        else if (!reachDirty && isMarked(a) != isMarked(b))
+            extend(isMarked(a) ? a : b, isMarked(a) ? b : a);
+    }
+    else if (isMarked(a) && isMarked(b)) {
+        reachDirty = true;
+    }
+}
+
+void IncrementalSolver::toggleWall(const int row, const int col, Maze::Direction dir) {
+    maze.toggleWall(row, col, dir);
+    int cell = row * cols + col;
+    update(cell, neighbor(cell, dir), dir);
+}
+
+void IncrementalSolver::toggleWall(const int row, const int col, Maze::Direction dir, Renderer& renderer) {
+    maze.toggleWall(row, col, dir, renderer);
+    int cell = row * cols + col;
+    update(cell, neighbor(cell, dir), dir);
+}
+
+bool IncrementalSolver::isConnected() const {
+    return connected;
+}
+
+bool IncrementalSolver::isOnPath(const int row, const int col) const {
+    return pathIndex[row * cols + col] >= 0;
+}
+
+int IncrementalSolver::getPathLength() const {
+    return (int) path.size();
+}
+
+std::vector<sf::Vector2u> IncrementalSolver::getPath() const {
+    std::vector<sf::Vector2u> cells;
+    cells.reserve(path.size());
+    for (int cell : path)
+        cells.push_back(sf::Vector2u(cell / cols, cell % cols));
+    return cells;
+}
+
+sf::Vector2u IncrementalSolver::getPathCell(int i) const {
+    return sf::Vector2u(path[i] / cols, path[i] % cols);
+}
+
+void IncrementalSolver::drawPath(Renderer& renderer, sf::Color fill) const {
+    for (std::size_t i = 0; i < path.size(); i++) {
+        int row = path[i] / cols;
+        int col = path[i] % cols;
+        renderer.toggleCell(row * 2 + 1, col * 2 + 1, fill);
+
+        // the wall slot between two neighbors is halfway between their cell slots
+        if (i > 0)
+            renderer.toggleWall(row + path[i - 1] / cols + 1, col + path[i - 1] % cols + 1, fill);
+    }
+}
+
+void IncrementalSolver::setRepairBudget(int cells) {
+    repairBudget = cells;
+}
+
+int IncrementalSolver::getFullSolves() const {
+    return fullSolves;
+}
@@ -0,0 +1,92 @@
+#ifndef INCREMENTAL_SOLVER_HPP
+#define INCREMENTAL_SOLVER_HPP
+
+#include "Maze.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+class Renderer;
+
+// keeps a path between two cells up to date while walls are edited instead of solving from scratch after every edit
+// - opening a wall never breaks the path, if it joins two cells on the path the path is shortened
+// - closing a wall that the path doesn't use costs nothing
+// - closing a wall on the path searches for a detour from the cut back onto the rest of the path, and only
+//   falls back to a full search if the detour takes more than the repair budget. if there is no detour (closing a
+//   path wall of a perfect maze) that search has already found every cell the start can still reach
+// - while the goal is unreachable the set of cells reachable from the start is grown as walls are opened
+// the path is always valid but after edits it isn't necessarily the shortest one (call solve for that)
+class IncrementalSolver {
+public:
+    // start and goal are (row, col) like Maze::getSize
+    IncrementalSolver(Maze& maze, sf::Vector2u start, sf::Vector2u goal);
+
+    // toggles the wall (see Maze::toggleWall) and repairs the path
+    void toggleWall(const int row, const int col, Maze::Direction dir);
+    void toggleWall(const int row, const int col, Maze::Direction dir, Renderer& renderer);
+
+    // picks up the maze's current size and new end points, then solves from scratch (buffers are kept)
+    void reset(sf::Vector2u start, sf::Vector2u goal);
+
+    // forgets the current path and runs a full breadth first search
+    void solve();
+
+    bool isConnected() const;
+    bool isOnPath(const int row, const int col) const;
+    int getPathLength() const;
+
+    // cells from start to goal (empty if the goal can't be reached)
+    std::vector<sf::Vector2u> getPath() const;
+
+    // cell i of the path, for going through it without copying it like getPath
+    sf::Vector2u getPathCell(int i) const;
+
+    // paints the cells of the path and the passages between them (paint it white to erase it again)
+    void drawPath(Renderer& renderer, sf::Color fill) const;
+
+    // how many cells a detour search may visit before giving up and solving from scratch
+    void setRepairBudget(int cells);
+
+    // number of full searches so far, handy to check that edits really are being repaired locally
+    int getFullSolves() const;
+
+private:
+    int neighbor(int cell, Maze::Direction dir) const;
+    bool isOpen(int cell, Maze::Direction dir) const;
+
+    void update(int a, int b, Maze::Direction dir);
+    void shortcut(int a, int b);
+    void repair(int a, int b);
+    void extend(int from, int to);
+
+    // starts a new search, previous search marks become invalid
+    void newSearch();
+    bool isMarked(int cell) const;
+    void mark(int cell, int parent);
+
+    void splice(int from, int to, const std::vector<int>& cells);
+
+    Maze& maze;
+    int rows;
+    int cols;
+    int start;
+    int goal;
+
+    bool connected = false;
+    // set when a wall closed inside the reachable area while disconnected, the reachable set has to be rebuilt
+    bool reachDirty = false;
+    int repairBudget = 4096;
+    int fullSolves = 0;
+
+    std::vector<int> path;
+    std::vector<int> pathIndex;
+
+    // search scratch, a cell is marked when stamp[cell] == currentStamp so nothing is cleared between searches
+    std::vector<unsigned int> stamp;
+    std::vector<int> parent;
+    std::vector<int> queue;
+    std::vector<int> detour;
+    unsigned int currentStamp = 0;
+};
+
+#endif /* INCREMENTAL_SOLVER_HPP */
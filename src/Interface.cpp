@@ -28,24 +28,23 @@ namespace ui {
             return i;
         }
 
+        // parses the value of a numeric command line option, leaving the default alone if it isn't a number
+        template <class T>
+        void parseNumber(const std::string& option, const char* arg, T& value) {
+            try {
+                value = (T) std::stoull(arg);
+            } catch (const std::logic_error&) {
+                std::cerr << "Invalid value " << arg << " for " << option << " (ignored)" << std::endl;
+            }
+        }
+
         // gets console input to determine the algorithm to animate
         MazeSolver::Algorithm getAlgorithm() {
-            std::cout << "Algorithms:\nRecursive Backtrack(1)\nGrowing Tree(2)\nEller's Algorithm(3)\nRecursive Division(4)" << std::endl;
-            int algoChoice = getInputInBounds(1, 4);
-
-            switch (algoChoice) {
-                case 1:
-                    return MazeSolver::Algorithm::RecursiveBacktrack;
-                case 2:
-                    return MazeSolver::Algorithm::GrowingTree;
-                case 3:
-                    return MazeSolver::Algorithm::Ellers;
-                case 4:
-                    return MazeSolver::Algorithm::RecursiveDivision;
-            }
+            std::cout << "Algorithms:\nRecursive Backtrack(1)\nGrowing Tree(2)\nEller's Algorithm(3)\nRecursive Division(4)\nBinary Tree(5)\nSidewinder(6)\nHunt and Kill(7)" << std::endl;
 
-            //unreachable
-            return MazeSolver::Algorithm::RecursiveBacktrack;
+            MazeSolver::Algorithm algo = MazeSolver::Algorithm::RecursiveBacktrack;
+            getAlgorithmFromNumber(getInputInBounds(1, 7), algo);
+            return algo;
         }
 
         // gets console input to determine the size of the maze
@@ -97,6 +96,15 @@ namespace ui {
         return info;
     }
 
+    // see header
+    RunInfo configureRace(RunInfo previous) {
+        RunInfo info {previous};
+        info.mazeSize = getMazeSize();
+        info.delay = getDelay();
+
+        return info;
+    }
+
     // load lines the input file (assumes that lines are all composed of a single 32-bit integer)
     std::vector<int> getLines(std::fstream& file) {
         std::vector<int> lines;
@@ -147,23 +155,10 @@ namespace ui {
             lines.pop_back();
             
             MazeSolver::Algorithm algoType;
-            switch (algo) {
-                case 1:
-                    algoType = MazeSolver::Algorithm::RecursiveBacktrack;
-                    break;
-                case 2:
-                    algoType = MazeSolver::Algorithm::GrowingTree;
-                    break;
-                case 3:
-                    algoType = MazeSolver::Algorithm::Ellers;
-                    break;
-                case 4:
-                    algoType = MazeSolver::Algorithm::RecursiveDivision;
-                    break;
-                default:
-                    // if the input isn't in bounds then oh well we tried
-                    std::cout << "Error: Could not parse run.dat (Interface.cpp: line 132))" << std::endl;
-                    return {};
+            if (!getAlgorithmFromNumber(algo, algoType)) {
+                // if the input isn't in bounds then oh well we tried
+                std::cout << "Error: Could not parse run.dat (Interface.cpp: line 132))" << std::endl;
+                return {};
             }
 
             unsigned int rows = lines.back();
@@ -187,4 +182,89 @@ namespace ui {
 
         return runs;
     }
+
+    // see header
+    bool getAlgorithmFromNumber(int number, MazeSolver::Algorithm& algo) {
+        switch (number) {
+            case 1:
+                algo = MazeSolver::Algorithm::RecursiveBacktrack;
+                return true;
+            case 2:
+                algo = MazeSolver::Algorithm::GrowingTree;
+                return true;
+            case 3:
+                algo = MazeSolver::Algorithm::Ellers;
+                return true;
+            case 4:
+                algo = MazeSolver::Algorithm::RecursiveDivision;
+                return true;
+            case 5:
+                algo = MazeSolver::Algorithm::BinaryTree;
+                return true;
+            case 6:
+                algo = MazeSolver::Algorithm::Sidewinder;
+                return true;
+            case 7:
+                algo = MazeSolver::Algorithm::HuntAndKill;
+                return true;
+        }
+        return false;
+    }
+
+    // see header
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+
+            if (arg == "--export" && i + 1 < argc)
+                options.exportFile = argv[++i];
+            else if (arg == "--export-graph" && i + 1 < argc)
+                options.graphFile = argv[++i];
+            else if (arg == "--ascii")
+                options.exportStyle = TextExporter::Style::Ascii;
+            else if (arg == "--validate" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.validateIterations);
+            else if (arg == "--max-size" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.maxSize);
+            else if (arg == "--serve")
+                options.serve = true;
+            else if (arg == "--socket" && i + 1 < argc) {
+                options.serve = true;
+                options.socketPath = argv[++i];
+            }
+            else if (arg == "--cache" && i + 1 < argc)
+                options.cacheDirectory = argv[++i];
+            else if (arg == "--cache-size" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.cacheMegabytes);
+            else if (arg == "--race" && i + 1 < argc) {
+                for (const char* c = argv[++i]; *c; c++) {
+                    MazeSolver::Algorithm algo;
+                    if (getAlgorithmFromNumber(*c - '0', algo))
+                        options.raceAlgos.push_back(algo);
+                    else std::cerr << "Unknown algorithm " << *c << " for --race (ignored)" << std::endl;
+                }
+            }
+            else if (arg == "--terminal")
+                options.terminal = true;
+            else if (arg == "--mask" && i + 1 < argc)
+                options.maskFile = argv[++i];
+            else if (arg == "--bench" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.benchmarkSize);
+            else if (arg == "--bench-paths" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.pathBenchmarkSize);
+            else if (arg == "--world" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.worldChunkSize);
+            else if (arg == "--threads" && i + 1 < argc)
+                parseNumber(arg, argv[++i], options.threads);
+            else if (arg == "--seed" && i + 1 < argc) {
+                parseNumber(arg, argv[++i], options.seed);
+                options.hasSeed = true;
+            }
+            else std::cerr << "Unknown option " << arg << " (ignored)" << std::endl;
+        }
+
+        return options;
+    }
 }
\ No newline at end of file
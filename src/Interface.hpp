@@ -2,6 +2,9 @@
 #define INTERFACE_HPP
 
 #include "MazeSolver.hpp"
+#include "TextExport.hpp"
+#include <cstdint>
+#include <string>
 #include <vector>
 
 // instance data for the animation
@@ -11,6 +14,53 @@ struct RunInfo {
     int delay;
 };
 
+// settings from the command line
+struct Options {
+    // when set the finished maze of every run is written to this file as text
+    std::string exportFile;
+    TextExporter::Style exportStyle = TextExporter::Style::Unicode;
+
+    // when set the finished maze of every run is written to this file as a corridor contracted graph
+    std::string graphFile;
+
+    // number of random mazes to check with the perfect maze validator instead of opening a window
+    std::uint64_t validateIterations = 0;
+    int maxSize = 64;
+
+    // size of the mazes used to benchmark the word parallel generators instead of opening a window
+    int benchmarkSize = 0;
+
+    // size of the maze used to benchmark the hierarchical path index instead of opening a window
+    int pathBenchmarkSize = 0;
+
+    // chunk size of the infinite world to print around the origin and check for reproducibility (--world <size>)
+    int worldChunkSize = 0;
+
+    // run as a generation service on stdin/stdout (--serve) or on a unix domain socket (--socket <path>)
+    bool serve = false;
+    std::string socketPath;
+
+    // directory of the on disk maze cache used by the service (--cache <dir>) and its size limit (--cache-size <MB>)
+    std::string cacheDirectory;
+    std::uint64_t cacheMegabytes = 1024;
+
+    // algorithms to run side by side in one window (--race <numbers>, e.g. --race 136), empty for a normal run
+    std::vector<MazeSolver::Algorithm> raceAlgos;
+
+    // draw the animation in the terminal instead of opening a window (--terminal)
+    bool terminal = false;
+
+    // image whose dark parts give the shape of every maze (--mask <image>), empty for plain rectangles
+    std::string maskFile;
+
+    // worker threads, 0 uses one per hardware thread
+    int threads = 0;
+
+    // seed for anything that needs to be reproducible, random unless given
+    std::uint64_t seed = 0;
+    bool hasSeed = false;
+};
+
 namespace ui {
     // self explanatory
     static void printRunInfo(RunInfo info) {
@@ -21,8 +71,17 @@ namespace ui {
     // gets user input from the console to configure the next animation
     RunInfo configureRun(RunInfo previous);
 
+    // gets the maze size and delay for a race from the console (the algorithm is ignored)
+    RunInfo configureRace(RunInfo previous);
+
     // loads automated runs from the specified file 
     std::vector<RunInfo> loadRunsFromFile(const std::string& fileName);
+
+    // converts the algorithm numbers used by the menu, run.dat and the server (1 to 7) into algorithms
+    bool getAlgorithmFromNumber(int number, MazeSolver::Algorithm& algo);
+
+    // parses the command line arguments, anything unknown is reported on stderr (stdout may belong to --serve) and skipped
+    Options parseOptions(int argc, char** argv);
 };
 
 #endif /* INTERFACE_HPP */
\ No newline at end of file
@@ -3,12 +3,30 @@
 #include "Render.hpp"
 #include "MazeSolver.hpp"
 #include "Interface.hpp"
+#include "Profiler.hpp"
+#include "TextExport.hpp"
+#include "GraphExport.hpp"
+#include "Validator.hpp"
+#include "BulkGenerators.hpp"
+#include "Server.hpp"
+#include "IncrementalSolver.hpp"
+#include "PathIndex.hpp"
+#include "RaceView.hpp"
+#include "TerminalView.hpp"
+#include "World.hpp"
 
 #include <string>
+#include <fstream>
+#include <random>
 #include <future>
 #include <chrono>
 #include <thread>
 
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
 // SOURCES:
 // http://www.astrolog.org/labyrnth/algrithm.htm
 // http://www.neocomputer.org/projects/eller.html
@@ -21,10 +39,16 @@ bool isReady(std::future<T> const& f){
 
 // start solver on another thread
 void getHandle(MazeSolver& solver, Maze& maze, sf::RenderWindow& window, Renderer& renderer, RunInfo info, std::future<void>& handle, sf::IntRect viewport) {
+    if (profiler::enabled)
+        profiler::beginRun();
+
+    // the last run's thread is done with the scratch memory by now
+    solver.resetScratch();
+
     switch (info.algo) {
     case MazeSolver::Algorithm::RecursiveBacktrack:
         handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, info]() {
-            start(&MazeSolver::recursiveBacktrack, solver, maze, window, renderer, info.delay, 0, 0, Maze::Direction::None);
+            start(&MazeSolver::recursiveBacktrack, solver, maze, window, renderer, info.delay, (int) maze.getFirstActive().x, (int) maze.getFirstActive().y, Maze::Direction::None);
         });
         break;
     case MazeSolver::Algorithm::GrowingTree:
@@ -41,7 +65,22 @@ void getHandle(MazeSolver& solver, Maze& maze, sf::RenderWindow& window, Rendere
         handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, info, viewport]() {
             maze.removeWalls();
             renderer.resize(maze, viewport, sf::Color::White);
-            start(&MazeSolver::recursiveDivision, solver, maze, window, renderer, info.delay, 0, 0, maze.getSize().x - 1, maze.getSize().y - 1, solver.irand(0, 100) > 50 ? true : false);
+            start(&MazeSolver::recursiveDivision, solver, maze, window, renderer, info.delay, 0, 0, maze.getSize().y - 1, maze.getSize().x - 1, solver.irand(0, 100) > 50 ? true : false);
+        });
+        break;
+    case MazeSolver::Algorithm::BinaryTree:
+        handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, info]() {
+            start(&MazeSolver::binaryTree, solver, maze, window, renderer, info.delay);
+        });
+        break;
+    case MazeSolver::Algorithm::Sidewinder:
+        handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, info]() {
+            start(&MazeSolver::sidewinder, solver, maze, window, renderer, info.delay);
+        });
+        break;
+    case MazeSolver::Algorithm::HuntAndKill:
+        handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, info]() {
+            start(&MazeSolver::huntAndKill, solver, maze, window, renderer, info.delay);
         });
         break;
     default:
@@ -50,9 +89,189 @@ void getHandle(MazeSolver& solver, Maze& maze, sf::RenderWindow& window, Rendere
     }
 }
 
-int main() {
+// resizes the maze for the next run and cuts it to the shape of the mask if there is one
+void prepareMaze(Maze& maze, sf::Vector2u size, const sf::Image* mask) {
+    maze.resize(size.x, size.y);
+    if (mask && !maze.applyMask(*mask))
+        std::cout << "The mask leaves no cells in a " << size.x << "x" << size.y << " maze (ignored)" << std::endl;
+}
+
+// everything that happens once a run's animation is done
+void finishRun(const Options& options, Maze& maze) {
+    // dump the counters and the trace so far (overwritten after every run)
+    if (profiler::enabled) {
+        profiler::endRun(std::cout);
+        profiler::writeChromeTrace("trace.json");
+    }
+
+    // write the finished maze out as text (overwritten after every run)
+    if (!options.exportFile.empty()) {
+        std::ofstream file(options.exportFile, std::ios::binary);
+        if (file)
+            TextExporter(options.exportStyle).write(file, maze);
+        else std::cout << "Could not open " << options.exportFile << std::endl;
+    }
+
+    // and as a graph (overwritten after every run)
+    if (!options.graphFile.empty()) {
+        std::ofstream file(options.graphFile, std::ios::binary);
+        if (file)
+            GraphExporter().write(file, maze);
+        else std::cout << "Could not open " << options.graphFile << std::endl;
+    }
+}
+
+// colour of the path shown on a finished maze
+const sf::Color pathFill(94, 146, 242);
+
+// finds the path between the first and the last cell of the finished maze and draws it
+void showPath(IncrementalSolver& editor, Maze& maze, Renderer& renderer) {
+    sf::Vector2u goal(maze.getSize().x - 1, maze.getSize().y - 1);
+    while (!maze.isActive(goal.x, goal.y)) {
+        if (goal.y > 0)
+            goal.y--;
+        else goal = sf::Vector2u(goal.x - 1, maze.getSize().y - 1);
+    }
+
+    editor.reset(maze.getFirstActive(), goal);
+    editor.drawPath(renderer, pathFill);
+}
+
+// toggles the wall in slot (i, j) of the renderer's grid, the path is repaired around the edit instead of searched again
+void editWall(IncrementalSolver& editor, Maze& maze, Renderer& renderer, int i, int j) {
+    // only walls between two cells of the maze, cells, corners and the border stay as they are
+    int rows = maze.getSize().x;
+    int cols = maze.getSize().y;
+    if ((i + j) % 2 == 0 || i == 0 || j == 0 || i == rows * 2 || j == cols * 2)
+        return;
+
+    int row = (i - 1) / 2;
+    int col = (j - 1) / 2;
+    Maze::Direction dir = (i % 2 != 0) ? Maze::Direction::Right : Maze::Direction::Down;
+    if (!maze.isActive(row, col) || !maze.isActive(dir == Maze::Direction::Down ? row + 1 : row, dir == Maze::Direction::Right ? col + 1 : col))
+        return;
+
+    editor.drawPath(renderer, sf::Color::White);
+    editor.toggleWall(row, col, dir);
+    renderer.toggleWall(i, j, maze.isOpen(row, col, dir) ? sf::Color::White : sf::Color::Black);
+    editor.drawPath(renderer, pathFill);
+}
+
+// same as the window but drawn in the terminal, for hosts without a display (the menu shows up below the maze)
+void runInTerminal(const Options& options, std::vector<RunInfo> runs, const sf::Image* mask) {
+    RunInfo info {MazeSolver::Algorithm::RecursiveBacktrack, sf::Vector2u(10, 10), 10};
+    Maze maze(info.mazeSize.x, info.mazeSize.y);
+    MazeSolver solver;
+
+    // the window is never opened, so the generators only draw through the renderer to the terminal
+    sf::RenderWindow window;
+    sf::IntRect viewport(0, 0, 0, 0);
+    TerminalView terminal;
+    Renderer renderer;
+    renderer.attach(&terminal);
+
+    while (true) {
+        if (runs.size() > 0) {
+            info = runs[0];
+            runs.erase(runs.begin());
+        }
+        else info = ui::configureRun(info);
+
+        prepareMaze(maze, info.mazeSize, mask);
+        renderer.resize(maze, viewport);
+
+        std::future<void> handle;
+        getHandle(solver, maze, window, renderer, info, handle, viewport);
+        handle.wait();
+
+        terminal.finish();
+        finishRun(options, maze);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options = ui::parseOptions(argc, argv);
+    if (options.threads <= 0)
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (!options.hasSeed)
+        options.seed = std::random_device()();
+
+    // shared by the service and the path index benchmark
+    std::unique_ptr<MazeCache> cache;
+    if (!options.cacheDirectory.empty())
+        cache = std::make_unique<MazeCache>(options.cacheDirectory, options.cacheMegabytes << 20);
+
+    // generation service, stdout belongs to the protocol from here on
+    if (options.serve) {
+        Server server(options.threads, cache.get());
+        if (!options.socketPath.empty())
+            return server.serveSocket(options.socketPath) ? 0 : 1;
+
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        server.serve(std::cin, std::cout);
+        return 0;
+    }
+
+    // measure the word parallel generators, no window needed
+    if (options.benchmarkSize > 0) {
+        bulk::benchmark(options.benchmarkSize, options.threads);
+        return 0;
+    }
+
+    // measure the path index against full searches, no window needed
+    if (options.pathBenchmarkSize > 0) {
+        hpa::benchmark(options.pathBenchmarkSize, options.threads, options.seed, cache.get());
+        return 0;
+    }
+
+    // print the chunks around the origin of the infinite world and check they come out the same every time
+    if (options.worldChunkSize > 0)
+        return world::explore(std::cout, options.seed, options.worldChunkSize, 1, options.exportStyle) ? 0 : 1;
+
+    // stress the generators with the perfect maze validator, no window needed
+    if (options.validateIterations > 0) {
+        std::cout << "Validating " << options.validateIterations << " mazes up to " << options.maxSize << "x" << options.maxSize
+                  << " on " << options.threads << " threads (seed " << options.seed << ")" << std::endl;
+        std::vector<MazeSolver::Algorithm> algos {MazeSolver::Algorithm::RecursiveBacktrack,
+                                                  MazeSolver::Algorithm::GrowingTree,
+                                                  MazeSolver::Algorithm::Ellers,
+                                                  MazeSolver::Algorithm::RecursiveDivision,
+                                                  MazeSolver::Algorithm::BinaryTree,
+                                                  MazeSolver::Algorithm::Sidewinder,
+                                                  MazeSolver::Algorithm::HuntAndKill};
+        auto failures = validator::stress(algos, options.validateIterations, 1, options.maxSize, options.threads, options.seed);
+
+        // every maze of the solver check gets a few hundred edits, so a hundredth of the mazes is plenty
+        failures += validator::stressSolver(algos, std::max<std::uint64_t>(options.validateIterations / 100, 1), options.maxSize, options.threads, options.seed);
+        return failures == 0 ? 0 : 1;
+    }
+
+    // run several algorithms side by side on the same seed
+    if (!options.raceAlgos.empty()) {
+        RunInfo info = ui::configureRace(RunInfo {MazeSolver::Algorithm::RecursiveBacktrack, sf::Vector2u(30, 30), 10});
+        RaceView(options.raceAlgos, info.mazeSize, info.delay, (unsigned int) options.seed).run();
+        return 0;
+    }
+
+    // shape of every maze, if it can't be loaded then oh well we tried and the mazes stay rectangles
+    sf::Image maskImage;
+    const sf::Image* mask = nullptr;
+    if (!options.maskFile.empty()) {
+        if (maskImage.loadFromFile(options.maskFile))
+            mask = &maskImage;
+        else std::cout << "Could not open " << options.maskFile << std::endl;
+    }
+
     // attempt to load any automated runs
     auto runs = ui::loadRunsFromFile("run.dat");
+
+    // no window, draw in the terminal instead
+    if (options.terminal) {
+        runInTerminal(options, runs, mask);
+        return 0;
+    }
     
     // if there are preloaded runs, run them, otherwise get user input
     RunInfo info;
@@ -64,8 +283,10 @@ int main() {
 
     // create maze and maze solver
     Maze maze(info.mazeSize.x, info.mazeSize.y);
+    prepareMaze(maze, info.mazeSize, mask);
     std::future<RunInfo> inputHandle;
     MazeSolver solver;
+    IncrementalSolver editor(maze, sf::Vector2u(0, 0), sf::Vector2u(0, 0));
 
     // open window
     sf::ContextSettings cs;
@@ -93,6 +314,14 @@ int main() {
                 case sf::Event::Closed:
                     window.close();
                     break;
+                case sf::Event::MouseButtonPressed:
+                    // walls of a finished maze can be toggled by clicking them
+                    if (done && e.mouseButton.button == sf::Mouse::Left) {
+                        int i, j;
+                        if (renderer.findSlot(window.mapPixelToCoords(sf::Vector2i(e.mouseButton.x, e.mouseButton.y)), i, j))
+                            editWall(editor, maze, renderer, i, j);
+                    }
+                    break;
             }
         }
 
@@ -112,7 +341,7 @@ int main() {
                 b = window.setActive(false);
 
                 // update the maze and renderer for the new run info
-                maze.resize(info.mazeSize.x, info.mazeSize.y);
+                prepareMaze(maze, info.mazeSize, mask);
                 renderer.resize(maze, viewport);
 
                 // start the animation again
@@ -124,6 +353,8 @@ int main() {
         // animation is done
         if (isReady(handle) && !done) {
             done = true;
+            finishRun(options, maze);
+            showPath(editor, maze, renderer);
 
             // if there are more automated runs then run them
             if (runs.size() > 0) {
@@ -1,18 +1,27 @@
 #include "Maze.hpp"
 #include "Render.hpp"
+#include "Profiler.hpp"
+#include "Bits.hpp"
 
 #include <SFML/Graphics.hpp>
+#include <string>
+#include <cstring>
+#include <algorithm>
 
 Maze::Maze(const int rows, const int cols) : rows(rows), cols(cols) {
     initialize();
 }
 
 std::ostream& operator<<(std::ostream& os, const Maze& maze) {
-    for (int i = 0; i < maze.grid.size(); i++) {
-        for (int j = 0; j < maze.grid[0].size(); j++)
-            os << maze.grid[i][j];
+    // build each row before handing it to the stream rather than inserting one character at a time
+    std::string line;
+    for (int i = 0; i < maze.rows * 2 + 1; i++) {
+        line.clear();
+        for (int j = 0; j < maze.cols * 2 + 1; j++)
+            line += maze.slot(i, j) ? '1' : '0';
         
-        os << "\n";
+        line += '\n';
+        os.write(line.data(), line.size());
     }
     
     return os;
@@ -25,52 +34,123 @@ void Maze::resize(const int rows, const int cols) {
 }
 
 void Maze::initialize() {
-    grid.resize(rows * 2 + 1); 
-    for (int i = 0; i < rows * 2 + 1; i++) {
-        grid[i] = std::vector<bool>(cols * 2 + 1);
-        for (int j = 0; j < grid[i].size(); j++)
-            if (j % 2 != 0 && i % 2 != 0)
-                grid[i][j] = true;
-    }
+    // every wall starts closed
+    words = (cols + 63) / 64;
+    right.assign((std::size_t) rows * words, 0);
+    down.assign((std::size_t) rows * words, 0);
+    mask.clear();
+}
+
+void Maze::reserve(const int rows, const int cols) {
+    std::size_t count = (std::size_t) rows * ((cols + 63) / 64);
+    right.reserve(count);
+    down.reserve(count);
+    mask.reserve(count);
 }
 
 Maze& Maze::operator=(const Maze& other) {
-    if (this != &other && other.grid.size() > 0) {
+    // vector assignment reuses the buffers when they are big enough
+    if (this != &other) {
         rows = other.rows;
         cols = other.cols;
-        for (int i = 0; i < other.grid.size(); i++)
-            for (int j = 0; j < other.grid[0].size(); j++)
-                grid[i][j] = other.grid[i][j];
+        words = other.words;
+        right = other.right;
+        down = other.down;
+        mask = other.mask;
     }
     return *this;
 }
 
-void Maze::toggleWall(const int row, const int col, Direction dir, Renderer& renderer, sf::Color cellFill, sf::Color wallFill) {
-    renderer.toggleCell(row * 2 + 1, col * 2 + 1, cellFill);
+bool Maze::getBit(const std::vector<std::uint64_t>& bits, const std::size_t index) {
+    return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+void Maze::flipBit(std::vector<std::uint64_t>& bits, const std::size_t index) {
+    bits[index / 64] ^= std::uint64_t(1) << (index % 64);
+}
+
+bool Maze::slot(const int i, const int j) const {
+    // cells are always open and nothing on the outer border ever is
+    if (i % 2 != 0 && j % 2 != 0)
+        return true;
+    if (i == 0 || j == 0 || i == rows * 2 || j == cols * 2)
+        return false;
+
+    // walls
+    if (i % 2 != 0)
+        return getBit(right, (std::size_t) (i / 2) * words * 64 + j / 2 - 1);
+    if (j % 2 != 0)
+        return getBit(down, (std::size_t) (i / 2 - 1) * words * 64 + j / 2);
+
+    // a corner is only open when all four walls around it are
+    return slot(i - 1, j) && slot(i + 1, j) && slot(i, j - 1) && slot(i, j + 1);
+}
+
+// converts a cell and a direction into the grid slot of the wall between the cell and its neighbor
+static bool wallSlot(const int row, const int col, Maze::Direction dir, int& i, int& j) {
+    i = row * 2 + 1;
+    j = col * 2 + 1;
+    switch (dir) {
+        case Maze::Direction::Up:
+            i--;
+            return true;
+        case Maze::Direction::Down:
+            i++;
+            return true;
+        case Maze::Direction::Left:
+            j--;
+            return true;
+        case Maze::Direction::Right:
+            j++;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void Maze::toggleWall(const int row, const int col, Direction dir) {
+    // walls on the outer border aren't stored so they can't be toggled
+    std::size_t index = (std::size_t) row * words * 64 + col;
+    std::vector<std::uint64_t>* bits;
     switch (dir) {
         case Direction::Up:
-            grid[row * 2][col * 2 + 1] = (grid[row * 2][col * 2 + 1] ? false : true);
-            renderer.toggleCell(row * 2 - 1, col * 2 + 1, cellFill);
-            renderer.toggleWall(row * 2, col * 2 + 1, wallFill);
+            if (row == 0) return;
+            bits = &down;
+            index -= words * 64;
             break;
         case Direction::Down:
-            grid[row * 2 + 2][col * 2 + 1] = (grid[row * 2 + 2][col * 2 + 1] ? false : true);
-            renderer.toggleCell(row * 2 + 3, col * 2 + 1, cellFill);
-            renderer.toggleWall(row * 2 + 2, col * 2 + 1, wallFill);
+            if (row == rows - 1) return;
+            bits = &down;
             break;
         case Direction::Left:
-            grid[row * 2 + 1][col * 2] = (grid[row * 2 + 1][col * 2] ? false : true);
-            renderer.toggleCell(row * 2 + 1, col * 2 - 1, cellFill);
-            renderer.toggleWall(row * 2 + 1, col * 2, wallFill);
+            if (col == 0) return;
+            bits = &right;
+            index--;
             break;
         case Direction::Right:
-            grid[row * 2 + 1][col * 2 + 2] = (grid[row * 2 + 1][col * 2 + 2] ? false : true);
-            renderer.toggleCell(row * 2 + 1, col * 2 + 3, cellFill);
-            renderer.toggleWall(row * 2 + 1, col * 2 + 2, wallFill);
+            if (col == cols - 1) return;
+            bits = &right;
             break;
-        case Direction::None:
+        default:
             return;
     }
+
+    PROFILE_COUNT(wallToggles, 1);
+    flipBit(*bits, index);
+    PROFILE_COUNT(cellsCarved, getBit(*bits, index) ? 1 : 0);
+}
+
+void Maze::toggleWall(const int row, const int col, Direction dir, Renderer& renderer, sf::Color cellFill, sf::Color wallFill) {
+    renderer.toggleCell(row * 2 + 1, col * 2 + 1, cellFill);
+
+    int i, j;
+    if (!wallSlot(row, col, dir, i, j))
+        return;
+
+    toggleWall(row, col, dir);
+    // the neighbor is one more slot past the wall
+    renderer.toggleCell(i * 2 - (row * 2 + 1), j * 2 - (col * 2 + 1), cellFill);
+    renderer.toggleWall(i, j, wallFill);
 }
 
 void Maze::toggleWall(const int row, const int col, Direction dir, Renderer& renderer) {
@@ -78,10 +158,15 @@ void Maze::toggleWall(const int row, const int col, Direction dir, Renderer& ren
 }
 
 bool Maze::isVisitedImpl(const int row, const int col) {
-    return grid[row * 2][col * 2 + 1] ||
-           grid[row * 2 + 2][col * 2 + 1] || 
-           grid[row * 2 + 1][col * 2] ||
-           grid[row * 2 + 1][col * 2 + 2];
+    // cells outside the mask count as visited so nothing ever carves into them
+    std::size_t index = (std::size_t) row * words * 64 + col;
+    if (!mask.empty() && !getBit(mask, index))
+        return true;
+
+    return (row > 0 && getBit(down, index - words * 64)) ||
+           getBit(down, index) ||
+           (col > 0 && getBit(right, index - 1)) ||
+           getBit(right, index);
 }
 
 bool Maze::isVisited(const int row, const int col, Direction dir) {
@@ -102,14 +187,211 @@ bool Maze::isVisited(const int row, const int col, Direction dir) {
     return false;
 }
 
-sf::Vector2u Maze::getSize() {
+bool Maze::isOpen(const int row, const int col, Direction dir) const {
+    std::size_t index = (std::size_t) row * words * 64 + col;
+    switch (dir) {
+        case Direction::Up:
+            return row > 0 && getBit(down, index - words * 64);
+        case Direction::Down:
+            return row < rows - 1 && getBit(down, index);
+        case Direction::Left:
+            return col > 0 && getBit(right, index - 1);
+        case Direction::Right:
+            return col < cols - 1 && getBit(right, index);
+        default:
+            return false;
+    }
+}
+
+std::size_t Maze::memoryUsage() const {
+    return sizeof(Maze) + (right.capacity() + down.capacity() + mask.capacity()) * sizeof(std::uint64_t);
+}
+
+void Maze::appendBinary(std::string& out) const {
+    std::uint32_t header[3] = {(std::uint32_t) rows, (std::uint32_t) cols, (std::uint32_t) words};
+    out.append("MAZE", 4);
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(right.data()), right.size() * sizeof(std::uint64_t));
+    out.append(reinterpret_cast<const char*>(down.data()), down.size() * sizeof(std::uint64_t));
+}
+
+bool Maze::readBinary(const char* data, const std::size_t size) {
+    return readBinary(size, [&data](char* buffer, std::size_t count) {
+        std::memcpy(buffer, data, count);
+        data += count;
+        return true;
+    });
+}
+
+bool Maze::readBinary(const std::size_t size, const Reader& read) {
+    char magic[4];
+    std::uint32_t header[3];
+    if (size < sizeof(magic) + sizeof(header) || !read(magic, sizeof(magic)) || std::memcmp(magic, "MAZE", 4) != 0 ||
+        !read(reinterpret_cast<char*>(header), sizeof(header)))
+        return false;
+
+    // the size has to match exactly, anything else is a truncated or foreign file
+    std::size_t count = (std::size_t) header[0] * header[2];
+    if (header[2] != (header[1] + 63) / 64 || size != sizeof(magic) + sizeof(header) + count * 2 * sizeof(std::uint64_t))
+        return false;
+
+    resize(header[0], header[1]);
+    if (!read(reinterpret_cast<char*>(right.data()), count * sizeof(std::uint64_t)) ||
+        !read(reinterpret_cast<char*>(down.data()), count * sizeof(std::uint64_t))) {
+        resize(header[0], header[1]);
+        return false;
+    }
+    return true;
+}
+
+sf::Vector2u Maze::getSize() const {
     return sf::Vector2u(rows, cols);
 }
 
 void Maze::removeWalls() {
-    for (int i = 0; i < rows * 2 + 1; i++) {
-        for (int j = 0; j < grid[i].size(); j++)
-            if ((j % 2 == 0 || i % 2 == 0) && (j != 0 && i != 0 && j != cols * 2 && i != rows * 2))
-                grid[i][j] = true;
+    // a word at a time, a cell opens to the right if the next cell is active too (which is never true past the last
+    // column) and down if the cell below is, so nothing leaves the mask and the bits past the last row stay clear
+    for (int row = 0; row < rows; row++) {
+        for (int word = 0; word < words; word++) {
+            std::uint64_t active = getActiveWord(row, word);
+            std::uint64_t next = word < words - 1 ? getActiveWord(row, word + 1) << 63 : 0;
+            right[(std::size_t) row * words + word] = active & ((active >> 1) | next);
+            down[(std::size_t) row * words + word] = row < rows - 1 ? active & getActiveWord(row + 1, word) : 0;
+        }
     }
-}
\ No newline at end of file
+}
+
+int Maze::getWordsPerRow() const {
+    return words;
+}
+
+const std::uint64_t* Maze::getRightWords(const int row) const {
+    return right.data() + (std::size_t) row * words;
+}
+
+const std::uint64_t* Maze::getDownWords(const int row) const {
+    return down.data() + (std::size_t) row * words;
+}
+
+std::uint64_t* Maze::getRightWords(const int row) {
+    return right.data() + (std::size_t) row * words;
+}
+
+std::uint64_t* Maze::getDownWords(const int row) {
+    return down.data() + (std::size_t) row * words;
+}
+
+bool Maze::applyMask(const sf::Image& image) {
+    PROFILE_SCOPE("Maze::applyMask");
+    mask.assign((std::size_t) rows * words, 0);
+
+    sf::Vector2u imageSize = image.getSize();
+    if (imageSize.x == 0 || imageSize.y == 0) {
+        mask.clear();
+        return false;
+    }
+
+    // sample the middle of every cell
+    std::vector<std::uint32_t> region((std::size_t) rows * cols, 0);
+    for (int row = 0; row < rows; row++) {
+        unsigned int y = (unsigned int) (((std::uint64_t) row * 2 + 1) * imageSize.y / (rows * 2));
+        for (int col = 0; col < cols; col++) {
+            unsigned int x = (unsigned int) (((std::uint64_t) col * 2 + 1) * imageSize.x / (cols * 2));
+            sf::Color pixel = image.getPixel(x, y);
+            if (pixel.a >= 128 && pixel.r * 299 + pixel.g * 587 + pixel.b * 114 < 128 * 1000)
+                region[(std::size_t) row * cols + col] = ~0u;
+        }
+    }
+
+    // number the connected regions with a flood fill and remember the largest
+    std::vector<std::uint32_t> queue;
+    std::uint32_t regions = 0;
+    std::uint32_t largest = 0;
+    std::size_t largestSize = 0;
+    for (std::uint32_t start = 0; start < region.size(); start++) {
+        if (region[start] != ~0u)
+            continue;
+
+        region[start] = ++regions;
+        queue.assign(1, start);
+        for (std::size_t next = 0; next < queue.size(); next++) {
+            std::uint32_t cell = queue[next];
+            int row = cell / cols;
+            int col = cell % cols;
+
+            std::uint32_t neighbours[4] = {cell - cols, cell + cols, cell - 1, cell + 1};
+            bool exists[4] = {row > 0, row < rows - 1, col > 0, col < cols - 1};
+            for (int i = 0; i < 4; i++) {
+                if (exists[i] && region[neighbours[i]] == ~0u) {
+                    region[neighbours[i]] = regions;
+                    queue.push_back(neighbours[i]);
+                }
+            }
+        }
+
+        if (queue.size() > largestSize) {
+            largestSize = queue.size();
+            largest = regions;
+        }
+    }
+
+    if (largestSize == 0) {
+        mask.clear();
+        return false;
+    }
+
+    for (std::size_t cell = 0; cell < region.size(); cell++)
+        if (region[cell] == largest)
+            flipBit(mask, (cell / cols) * words * 64 + cell % cols);
+
+    // nothing may lead out of the mask, a passage needs active cells on both sides
+    for (int row = 0; row < rows; row++) {
+        std::size_t first = (std::size_t) row * words;
+        for (int word = 0; word < words; word++) {
+            std::uint64_t next = word < words - 1 ? mask[first + word + 1] << 63 : 0;
+            right[first + word] &= mask[first + word] & ((mask[first + word] >> 1) | next);
+            down[first + word] &= row < rows - 1 ? mask[first + word] & mask[first + words + word] : 0;
+        }
+    }
+    return true;
+}
+
+void Maze::clearMask() {
+    mask.clear();
+}
+
+bool Maze::hasMask() const {
+    return !mask.empty();
+}
+
+bool Maze::isActive(const int row, const int col) const {
+    return mask.empty() || getBit(mask, (std::size_t) row * words * 64 + col);
+}
+
+std::uint64_t Maze::getActiveCount() const {
+    if (mask.empty())
+        return (std::uint64_t) rows * cols;
+
+    std::uint64_t count = 0;
+    for (std::uint64_t word : mask)
+        count += bits::popcount(word);
+    return count;
+}
+
+sf::Vector2u Maze::getFirstActive() const {
+    for (std::size_t i = 0; i < mask.size(); i++)
+        if (mask[i])
+            return sf::Vector2u((unsigned int) (i / words), (unsigned int) ((i % words) * 64 + bits::countTrailingZeros(mask[i])));
+
+    return sf::Vector2u(0, 0);
+}
+
+const std::uint64_t* Maze::getMaskWords(const int row) const {
+    return mask.empty() ? nullptr : mask.data() + (std::size_t) row * words;
+}
+
+std::uint64_t Maze::getActiveWord(const int row, const int word) const {
+    if (!mask.empty())
+        return mask[(std::size_t) row * words + word];
+    return word == words - 1 ? bits::lowMask(cols - word * 64) : ~0ull;
+}
@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <iostream>
+#include <cstdint>
+#include <functional>
+#include <string>
 
 // forward declarations
 class Renderer;
@@ -13,6 +16,7 @@ namespace sf {
     using Vector2u = Vector2<unsigned int>;
 
     class Color;
+    class Image;
 }
 
 // represents the maze to be generated 
@@ -26,12 +30,21 @@ public:
 
     friend class Renderer;
 
+    // copies and moves, moving hands over the buffers without copying
+    Maze(const Maze& other) = default;
+    Maze(Maze&& other) noexcept = default;
+
     // assignment operator overloads
     Maze& operator=(const Maze& other);
+    Maze& operator=(Maze&& other) noexcept = default;
 
-    // resizes the maze to the new specified size 
+    // resizes the maze to the new specified size, the buffers keep their capacity so this only allocates when the
+    // maze grows past any size it had before
     void resize(const int rows, const int cols);
 
+    // makes room for a rows x cols maze (with a mask) up front so resizing to it later doesn't allocate
+    void reserve(const int rows, const int cols);
+
     //
     enum class Direction {
         Up,
@@ -41,24 +54,87 @@ public:
         None
     };
 
-    sf::Vector2u getSize();
+    sf::Vector2u getSize() const;
 
+    // toggles the wall without drawing anything (used by headless generation)
+    void toggleWall(const int row, const int col, Direction dir);
     void toggleWall(const int row, const int col, Direction dir, Renderer& renderer);
     void toggleWall(const int row, const int col, Direction dir, Renderer& renderer, sf::Color cellFill, sf::Color wallFill);
 
     bool isVisited(const int row, const int col, Direction dir);
 
+    // true if there is a passage from the cell in the given direction
+    bool isOpen(const int row, const int col, Direction dir) const;
+
+    // approximate number of bytes held by this maze
+    std::size_t memoryUsage() const;
+
+    // appends the maze in its binary form: "MAZE", then rows, cols and words per row as 32 bit unsigned
+    // integers, then the right and down bitmaps as 64 bit words (everything in host byte order)
+    void appendBinary(std::string& out) const;
+
+    // loads a maze written by appendBinary, returns false (leaving the maze alone) if the data isn't a valid maze
+    bool readBinary(const char* data, const std::size_t size);
+
+    // same from a file or a socket, read has to fill the whole buffer it is given or fail and size is how many bytes
+    // there are to read. the bitmaps are read straight into the maze's buffers. returns false if the header isn't
+    // valid for size (leaving the maze alone) or if a read fails (leaving the maze with every wall closed)
+    using Reader = std::function<bool(char* buffer, std::size_t count)>;
+    bool readBinary(const std::size_t size, const Reader& read);
+
+    // opens every wall between two active cells
     void removeWalls();
 
+    // shape masks, only the active cells belong to the maze and the generators never carve into the rest
+    // (see MazeSolver::fitToMask). without a mask every cell is active, resize clears the mask
+    //
+    // samples the image over the maze (stretched to fit), a cell is active where the image is dark and opaque. only
+    // the largest connected region is kept so the maze stays in one piece, returns false if nothing is active
+    bool applyMask(const sf::Image& image);
+    void clearMask();
+    bool hasMask() const;
+    bool isActive(const int row, const int col) const;
+    std::uint64_t getActiveCount() const;
+
+    // first active cell in row major order, (0, 0) without a mask
+    sf::Vector2u getFirstActive() const;
+
+    // active cells of a row in the same layout as the passage words, nullptr without a mask
+    const std::uint64_t* getMaskWords(const int row) const;
+
+    // one word of a row's active cells, every cell of the row without a mask (never any bits past the last column)
+    std::uint64_t getActiveWord(const int row, const int word) const;
+
+    // raw passage bitmaps for word at a time access, bit (col % 64) of word (col / 64) of a row is the cell
+    // right has the passages to the cell on the right, down the passages to the cell below
+    // writers must leave the bits past the last column (and the down bits of the last row) clear
+    int getWordsPerRow() const;
+    const std::uint64_t* getRightWords(const int row) const;
+    const std::uint64_t* getDownWords(const int row) const;
+    std::uint64_t* getRightWords(const int row);
+    std::uint64_t* getDownWords(const int row);
+
 private:
-    std::vector<std::vector<bool>> grid;
+    // passages are stored as two bitmaps with one bit per cell, a set bit is an open passage
+    std::vector<std::uint64_t> right;
+    std::vector<std::uint64_t> down;
+
+    // one bit per active cell in the same layout, empty when the whole rectangle is the maze
+    std::vector<std::uint64_t> mask;
 
     void initialize();
 
     bool isVisitedImpl(const int row, const int col);
 
+    // state of a slot in the (rows * 2 + 1) x (cols * 2 + 1) grid of cells, walls and corners that the renderer draws
+    bool slot(const int i, const int j) const;
+
+    static bool getBit(const std::vector<std::uint64_t>& bits, const std::size_t index);
+    static void flipBit(std::vector<std::uint64_t>& bits, const std::size_t index);
+
     int rows;
     int cols;
+    int words;
 };
 
 static void printDir(Maze::Direction dir) {
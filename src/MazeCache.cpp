@@ -0,0 +1,303 @@
+#include "MazeCache.hpp"
+#include "PathIndex.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// eviction goes down to this fraction of the budget so it doesn't run again on the very next store
+constexpr std::uint64_t evictNumerator = 3;
+constexpr std::uint64_t evictDenominator = 4;
+
+// temporary files older than this belong to a store that never finished
+constexpr auto staleTemp = std::chrono::hours(1);
+
+MazeCache::MazeCache(const std::string& directory, std::uint64_t maxBytes) : directory(directory), maxBytes(maxBytes) {
+    salt = ((std::uint64_t) std::random_device()() << 32) ^ std::random_device()();
+
+    std::error_code error;
+    fs::create_directories(this->directory, error);
+    if (error || !fs::is_directory(this->directory, error)) {
+        std::cerr << "Could not use " << directory << " as a cache directory" << std::endl;
+        return;
+    }
+    usable = true;
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(this->directory, error)) {
+        // an entry that can't be looked at is left to the next eviction scan
+        std::error_code entryError;
+        std::uint64_t size = entry.file_size(entryError);
+        if (isEntry(entry.path()) && !entryError)
+            totalBytes += size;
+    }
+}
+
+bool MazeCache::isUsable() const {
+    return usable;
+}
+
+std::uint64_t MazeCache::getHits() const {
+    return hits;
+}
+
+std::uint64_t MazeCache::getMisses() const {
+    return misses;
+}
+
+MazeCache::Header MazeCache::makeHeader(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed) {
+    return Header {{'M', 'Z', 'C', '1'}, (std::uint32_t) MazeSolver::version, (std::uint32_t) algo,
+                   (std::uint32_t) rows, (std::uint32_t) cols, seed};
+}
+
+bool MazeCache::isEntry(const fs::path& path) {
+    return path.extension() == ".maze" || path.extension() == ".hpai";
+}
+
+fs::path MazeCache::getPath(const Header& header, const char* extension) const {
+    std::uint64_t key = rnd::hashCombine(header.version, header.algo);
+    key = rnd::hashCombine(key, header.rows);
+    key = rnd::hashCombine(key, header.cols);
+    key = rnd::hashCombine(key, header.seed);
+
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx%s", (unsigned long long) key, extension);
+    return directory / name;
+}
+
+#ifndef _WIN32
+bool MazeCache::readEntry(const fs::path& path, const Header& header, Maze& maze) {
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+        return false;
+
+    auto read = [file](char* buffer, std::size_t count) {
+        while (count > 0) {
+            ssize_t done = ::read(file, buffer, count);
+            if (done < 0 && errno == EINTR)
+                continue;
+            if (done <= 0)
+                return false;
+            buffer += done;
+            count -= done;
+        }
+        return true;
+    };
+
+    struct stat info;
+    Header stored;
+    bool loaded = fstat(file, &info) == 0 && (std::size_t) info.st_size > sizeof(Header) &&
+                  read(reinterpret_cast<char*>(&stored), sizeof(Header)) && std::memcmp(&stored, &header, sizeof(Header)) == 0 &&
+                  maze.readBinary((std::size_t) info.st_size - sizeof(Header), read);
+
+    close(file);
+    return loaded;
+}
+
+bool MazeCache::writeEntry(const fs::path& path, const std::string& data) {
+    int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0)
+        return false;
+
+    std::size_t written = 0;
+    while (written < data.size()) {
+        ssize_t done = write(file, data.data() + written, data.size() - written);
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done <= 0)
+            break;
+        written += done;
+    }
+
+    // on disk before the rename makes it visible, otherwise a crash could leave a short file under the entry's name
+    bool ok = written == data.size() && fsync(file) == 0;
+    return close(file) == 0 && ok;
+}
+#else
+bool MazeCache::readEntry(const fs::path& path, const Header& header, Maze& maze) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::size_t size = (std::size_t) file.tellg();
+    file.seekg(0);
+
+    Header stored;
+    return size > sizeof(Header) && file.read(reinterpret_cast<char*>(&stored), sizeof(Header)) &&
+           std::memcmp(&stored, &header, sizeof(Header)) == 0 &&
+           maze.readBinary(size - sizeof(Header), [&file](char* buffer, std::size_t count) { return (bool) file.read(buffer, count); });
+}
+
+// no fsync here, the stream's flush is as far as it goes
+bool MazeCache::writeEntry(const fs::path& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file.write(data.data(), data.size()) && file.flush();
+}
+#endif
+
+// an index is read whole, it has to be checked before any of it is used
+bool MazeCache::readEntry(const fs::path& path, const Header& header, std::string& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    std::size_t size = (std::size_t) file.tellg();
+    file.seekg(0);
+
+    Header stored;
+    if (size <= sizeof(Header) || !file.read(reinterpret_cast<char*>(&stored), sizeof(Header)) ||
+        std::memcmp(&stored, &header, sizeof(Header)) != 0)
+        return false;
+
+    data.resize(size - sizeof(Header));
+    return (bool) file.read(&data[0], data.size());
+}
+
+void MazeCache::touch(const fs::path& path) {
+    // the modification time doubles as the last use time for eviction
+    std::error_code error;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+    hits++;
+}
+
+bool MazeCache::load(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, Maze& maze) {
+    if (!usable) {
+        misses++;
+        return false;
+    }
+
+    Header header = makeHeader(algo, rows, cols, seed);
+    fs::path path = getPath(header, ".maze");
+
+    if (!readEntry(path, header, maze)) {
+        misses++;
+        return false;
+    }
+
+    touch(path);
+    return true;
+}
+
+bool MazeCache::loadIndex(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, PathIndex& index) {
+    if (!usable) {
+        misses++;
+        return false;
+    }
+
+    Header header = makeHeader(algo, rows, cols, seed);
+    fs::path path = getPath(header, ".hpai");
+
+    std::string data;
+    if (!readEntry(path, header, data) || !index.readBinary(data.data(), data.size())) {
+        misses++;
+        return false;
+    }
+
+    touch(path);
+    return true;
+}
+
+void MazeCache::store(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, const Maze& maze) {
+    if (!usable)
+        return;
+
+    Header header = makeHeader(algo, rows, cols, seed);
+    std::string data(reinterpret_cast<const char*>(&header), sizeof(Header));
+    maze.appendBinary(data);
+    replaceEntry(getPath(header, ".maze"), data);
+}
+
+void MazeCache::storeIndex(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, const PathIndex& index) {
+    if (!usable)
+        return;
+
+    Header header = makeHeader(algo, rows, cols, seed);
+    std::string data(reinterpret_cast<const char*>(&header), sizeof(Header));
+    index.appendBinary(data);
+    replaceEntry(getPath(header, ".hpai"), data);
+}
+
+void MazeCache::replaceEntry(const fs::path& path, const std::string& data) {
+    if (data.size() > maxBytes)
+        return;
+
+    char suffix[24];
+    std::snprintf(suffix, sizeof(suffix), ".%016llx", (unsigned long long) rnd::hashCombine(salt, tempCount++));
+    fs::path temp = path;
+    temp += suffix;
+
+    if (!writeEntry(temp, data)) {
+        std::error_code error;
+        fs::remove(temp, error);
+        return;
+    }
+
+    // rename replaces an entry another worker may have stored in the meantime, which is the same data anyway
+    std::error_code error;
+    std::uint64_t replaced = fs::exists(path, error) ? fs::file_size(path, error) : 0;
+    fs::rename(temp, path, error);
+    if (error) {
+        fs::remove(temp, error);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    totalBytes += data.size() - std::min<std::uint64_t>(replaced, data.size());
+    if (totalBytes > maxBytes)
+        evict();
+}
+
+void MazeCache::evict() {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type lastUse;
+        std::uint64_t size;
+    };
+
+    // rescan rather than trust the running total, other processes may share the directory
+    std::vector<Entry> entries;
+    std::error_code error;
+    totalBytes = 0;
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, error)) {
+        std::error_code entryError;
+        if (!isEntry(entry.path())) {
+            // a temporary file left behind by a process that died halfway through a store
+            if (isEntry(entry.path().stem()) &&
+                entry.last_write_time(entryError) + staleTemp < fs::file_time_type::clock::now() && !entryError)
+                fs::remove(entry.path(), entryError);
+            continue;
+        }
+
+        Entry e {entry.path(), entry.last_write_time(entryError), entry.file_size(entryError)};
+        if (!entryError) {
+            entries.push_back(e);
+            totalBytes += e.size;
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+
+    std::uint64_t target = maxBytes / evictDenominator * evictNumerator;
+    for (const Entry& entry : entries) {
+        if (totalBytes <= target)
+            break;
+
+        if (fs::remove(entry.path, error))
+            totalBytes -= entry.size;
+    }
+}
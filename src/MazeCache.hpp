@@ -0,0 +1,96 @@
+#ifndef MAZECACHE_HPP
+#define MAZECACHE_HPP
+
+#include "Maze.hpp"
+#include "MazeSolver.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+class PathIndex;
+
+// content addressed cache of generated mazes on local disk
+//
+// an entry is keyed by everything that decides what a maze looks like (algorithm, size, seed and MazeSolver::version)
+// so a cached maze is always the maze the generator would make. entries are the binary maze from Maze::appendBinary
+// behind a small header repeating the parameters, written to a temporary file and renamed into place so a reader
+// (or another process sharing the directory) never sees half a file, and flushed to disk before that so a crash can't
+// leave a truncated entry behind. hits are read straight into the maze and touched, and once the directory grows past
+// its budget the least recently used entries are removed
+//
+// a maze can also have its path index (see PathIndex::appendBinary) stored next to it under the same key, the index
+// checks that it belongs to the maze it's loaded for so an index outliving its maze is just a miss
+class MazeCache {
+public:
+    MazeCache(const std::string& directory, std::uint64_t maxBytes);
+
+    // false if the directory couldn't be created, every lookup misses and nothing is stored in that case
+    bool isUsable() const;
+
+    // loads the maze made with these parameters into maze, returns false on a miss
+    bool load(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, Maze& maze);
+
+    // stores a maze made with these parameters and evicts old entries if the cache went over budget
+    void store(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, const Maze& maze);
+
+    // loads the path index stored for the maze made with these parameters, index must already be over that maze
+    bool loadIndex(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, PathIndex& index);
+    void storeIndex(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed, const PathIndex& index);
+
+    std::uint64_t getHits() const;
+    std::uint64_t getMisses() const;
+
+private:
+    // what every entry starts with, checked on load so a hash collision or a stale file is just a miss
+    struct Header {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t algo;
+        std::uint32_t rows;
+        std::uint32_t cols;
+        std::uint32_t seed;
+    };
+
+    static Header makeHeader(MazeSolver::Algorithm algo, int rows, int cols, std::uint32_t seed);
+    std::filesystem::path getPath(const Header& header, const char* extension) const;
+
+    // mazes are .maze files and path indices .hpai files, anything else in the directory isn't counted
+    static bool isEntry(const std::filesystem::path& path);
+
+    // reads an entry straight into maze's buffers
+    static bool readEntry(const std::filesystem::path& path, const Header& header, Maze& maze);
+
+    // reads a whole entry after its header into data
+    static bool readEntry(const std::filesystem::path& path, const Header& header, std::string& data);
+
+    // writes data to a new file and flushes it to disk
+    static bool writeEntry(const std::filesystem::path& path, const std::string& data);
+
+    // marks an entry as just used for eviction and counts the hit
+    void touch(const std::filesystem::path& path);
+
+    // puts data in place of the entry at path through a temporary file and evicts if the cache went over budget
+    void replaceEntry(const std::filesystem::path& path, const std::string& data);
+
+    // removes the least recently used entries until the cache is back under budget, must hold the lock
+    void evict();
+
+    std::filesystem::path directory;
+    std::uint64_t maxBytes;
+    bool usable = false;
+
+    // makes temporary file names unique between caches (and processes) sharing a directory
+    std::uint64_t salt;
+    std::atomic<std::uint64_t> tempCount {0};
+
+    std::mutex mutex;
+    std::uint64_t totalBytes = 0;
+
+    std::atomic<std::uint64_t> hits {0};
+    std::atomic<std::uint64_t> misses {0};
+};
+
+#endif /* MAZECACHE_HPP */
@@ -1,13 +1,24 @@
 #include "MazeSolver.hpp"
 #include "Maze.hpp"
 #include "Render.hpp"
+#include "BulkGenerators.hpp"
+#include "Bits.hpp"
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <thread>
 #include <map>
+#include <vector>
 
 MazeSolver::MazeSolver() : rng(rd()) {}
 
+MazeSolver::MazeSolver(unsigned int seed) : rng(seed), gen(seed) {}
+
+void MazeSolver::seed(unsigned int seed) {
+    rng.seed(seed);
+    gen.seed(seed);
+}
+
 sf::Vector2u changePosition(int row, int col, Maze::Direction dir) {
     sf::Vector2u pos(row, col);
     
@@ -48,27 +59,134 @@ void backtrack(int row, int col, sf::RenderWindow& window, Renderer& renderer, M
 }
 
 void MazeSolver::update(sf::RenderWindow& window, Renderer& renderer, int delay) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    PROFILE_SCOPE("MazeSolver::update");
+    PROFILE_COUNT(animationSteps, 1);
+    steps.fetch_add(1, std::memory_order_relaxed);
+    if (!skippingDelay.load(std::memory_order_relaxed)) {
+        PROFILE_SCOPE("sleep");
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    }
+    renderer.present();
+
+    // headless runs (see generate) never open their window
+    if (!window.isOpen())
+        return;
+
     window.clear(sf::Color::White);
     renderer.draw(window);
-    window.display();
+    {
+        PROFILE_SCOPE("display");
+        window.display();
+    }
+}
+
+std::uint64_t MazeSolver::getSteps() const {
+    return steps.load(std::memory_order_relaxed);
+}
+
+void MazeSolver::skipDelay() {
+    skippingDelay = true;
+}
+
+void MazeSolver::resetScratch() {
+    scratch.reset();
+}
+
+void MazeSolver::generate(Maze& maze, Algorithm algo) {
+    resetScratch();
+
+    // a window that is never opened and a renderer without shapes turn all of the drawing into no-ops
+    sf::RenderWindow window;
+    Renderer renderer;
+
+    switch (algo) {
+        case Algorithm::RecursiveBacktrack:
+            recursiveBacktrack(maze, window, renderer, 0, maze.getFirstActive().x, maze.getFirstActive().y, Maze::Direction::None);
+            break;
+        case Algorithm::GrowingTree:
+            growingTree(maze, window, renderer, 0);
+            break;
+        case Algorithm::Ellers:
+            ellers(maze, window, renderer, 0);
+            break;
+        case Algorithm::RecursiveDivision:
+            maze.removeWalls();
+            recursiveDivision(maze, window, renderer, 0, 0, 0, maze.getSize().y - 1, maze.getSize().x - 1, irand(0, 100) > 50 ? true : false);
+            break;
+        case Algorithm::BinaryTree:
+            // nothing to draw, so skip the reveal
+            bulk::binaryTree(maze, getSeed(), 1);
+            break;
+        case Algorithm::Sidewinder:
+            bulk::sidewinder(maze, getSeed(), 1);
+            break;
+        case Algorithm::HuntAndKill:
+            huntAndKill(maze, window, renderer, 0);
+            break;
+    }
+
+    fitToMask(maze, window, renderer, 0);
+}
+
+// one bit per cell that hasn't been visited yet in the maze's word layout, filled from the active words so the cells
+// outside a mask start out visited and the walks never look at the mask (or a neighbour's passages) cell by cell
+static void fillUnvisited(const Maze& maze, std::pmr::vector<std::uint64_t>& unvisited) {
+    int words = maze.getWordsPerRow();
+    unvisited.resize((std::size_t) maze.getSize().x * words);
+    for (int row = 0; row < (int) maze.getSize().x; row++)
+        for (int word = 0; word < words; word++)
+            unvisited[(std::size_t) row * words + word] = maze.getActiveWord(row, word);
+}
+
+// true if the neighbour in that direction is inside the maze and hasn't been visited yet
+static bool isUnvisitedNeighbour(const Maze& maze, const std::pmr::vector<std::uint64_t>& unvisited, int row, int col, Maze::Direction dir) {
+    row += (dir == Maze::Direction::Down) - (dir == Maze::Direction::Up);
+    col += (dir == Maze::Direction::Right) - (dir == Maze::Direction::Left);
+    if (row < 0 || col < 0 || row >= (int) maze.getSize().x || col >= (int) maze.getSize().y)
+        return false;
+
+    return (unvisited[(std::size_t) row * maze.getWordsPerRow() + col / 64] >> (col % 64)) & 1;
+}
+
+static void markVisited(const Maze& maze, std::pmr::vector<std::uint64_t>& unvisited, int row, int col) {
+    unvisited[(std::size_t) row * maze.getWordsPerRow() + col / 64] &= ~(1ull << (col % 64));
+}
+
+// the walls of a word of a row with active cells on both sides, to the right and below
+static std::uint64_t getRightKeep(const Maze& maze, int row, int word) {
+    std::uint64_t active = maze.getActiveWord(row, word);
+    std::uint64_t next = word < maze.getWordsPerRow() - 1 ? maze.getActiveWord(row, word + 1) << 63 : 0;
+    return active & ((active >> 1) | next);
+}
+
+static std::uint64_t getDownKeep(const Maze& maze, int row, int word) {
+    return row < (int) maze.getSize().x - 1 ? maze.getActiveWord(row, word) & maze.getActiveWord(row + 1, word) : 0;
 }
 
 void MazeSolver::recursiveBacktrack(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay, int row, int col, Maze::Direction dir) {
-    std::vector<Maze::Direction> dirs {Maze::Direction::Up, 
-                                       Maze::Direction::Left, 
-                                       Maze::Direction::Down, 
-                                       Maze::Direction::Right};
+    std::pmr::vector<std::uint64_t> unvisited(scratch.get());
+    fillUnvisited(maze, unvisited);
+    markVisited(maze, unvisited, row, col);
+
+    backtrackFrom(maze, window, renderer, delay, unvisited, row, col, dir);
+}
+
+void MazeSolver::backtrackFrom(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay, std::pmr::vector<std::uint64_t>& unvisited, int row, int col, Maze::Direction dir) {
+    std::array<Maze::Direction, 4> dirs {Maze::Direction::Up, 
+                                         Maze::Direction::Left, 
+                                         Maze::Direction::Down, 
+                                         Maze::Direction::Right};
 
     std::shuffle(std::begin(dirs), std::end(dirs), rng);
 
     for (const auto& dir : dirs) {
-        if (!maze.isVisited(row, col, dir)) {
+        if (isUnvisitedNeighbour(maze, unvisited, row, col, dir)) {
             maze.toggleWall(row, col, dir, renderer);
             auto pos = changePosition(row, col, dir);
+            markVisited(maze, unvisited, pos.x, pos.y);
 
             update(window, renderer, delay);
-            recursiveBacktrack(maze, window, renderer, delay, pos.x, pos.y, dir);
+            backtrackFrom(maze, window, renderer, delay, unvisited, pos.x, pos.y, dir);
         }
     }
 
@@ -84,10 +202,10 @@ void MazeSolver::recursiveBacktrack(Maze& maze, sf::RenderWindow& window, Render
 }
 
 Maze::Direction MazeSolver::getRandomDir() {
-    std::vector<Maze::Direction> dirs {Maze::Direction::Up, 
-                                       Maze::Direction::Left, 
-                                       Maze::Direction::Down, 
-                                       Maze::Direction::Right};
+    std::array<Maze::Direction, 4> dirs {Maze::Direction::Up, 
+                                         Maze::Direction::Left, 
+                                         Maze::Direction::Down, 
+                                         Maze::Direction::Right};
 
     std::shuffle(std::begin(dirs), std::end(dirs), rng);
 
@@ -95,48 +213,56 @@ Maze::Direction MazeSolver::getRandomDir() {
 }
 
 int MazeSolver::irand(int min, int max) {
-    if (min == max)
-        return min;
+	if (min == max)
+		return min;
 	std::uniform_int_distribution<> dis{ min, max };
 
 	return dis(gen);
 }
 
-bool hasUnvisitedNeighbors(int row, int col, Maze& maze) {
-    std::vector<Maze::Direction> dirs {Maze::Direction::Up, 
-                                       Maze::Direction::Left, 
-                                       Maze::Direction::Down, 
-                                       Maze::Direction::Right};
+bool hasUnvisitedNeighbors(int row, int col, const Maze& maze, const std::pmr::vector<std::uint64_t>& unvisited) {
+    std::array<Maze::Direction, 4> dirs {Maze::Direction::Up, 
+                                         Maze::Direction::Left, 
+                                         Maze::Direction::Down, 
+                                         Maze::Direction::Right};
     
     for (Maze::Direction dir : dirs)
-        if (!maze.isVisited(row, col, dir))
+        if (isUnvisitedNeighbour(maze, unvisited, row, col, dir))
             return true;
     return false;
 }
 
-std::pair<sf::Vector2u, Maze::Direction> MazeSolver::getCell(std::vector<std::pair<sf::Vector2u, Maze::Direction>>& cells) {
+std::pair<sf::Vector2u, Maze::Direction> MazeSolver::getCell(std::pmr::vector<std::pair<sf::Vector2u, Maze::Direction>>& cells) {
    return cells[irand(0, cells.size() - 1)];
 }
 
 void MazeSolver::growingTree(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
-    std::vector<std::pair<sf::Vector2u, Maze::Direction>> cells;
+    std::pmr::vector<std::pair<sf::Vector2u, Maze::Direction>> cells(scratch.get());
+    std::pmr::vector<std::uint64_t> unvisited(scratch.get());
+    fillUnvisited(maze, unvisited);
     
-    cells.push_back(std::make_pair(sf::Vector2u(irand(0, maze.getSize().x - 1), irand(0, maze.getSize().y - 1)), Maze::Direction::None));
+    sf::Vector2u first(irand(0, maze.getSize().x - 1), irand(0, maze.getSize().y - 1));
+    if (!maze.isActive(first.x, first.y))
+        first = maze.getFirstActive();
+    markVisited(maze, unvisited, first.x, first.y);
+    cells.push_back(std::make_pair(first, Maze::Direction::None));
     while (!cells.empty()) {
         auto cell = getCell(cells);
 
-        if (hasUnvisitedNeighbors(cell.first.x, cell.first.y, maze)) {
-            std::vector<Maze::Direction> dirs {Maze::Direction::Up, 
-                                       Maze::Direction::Left, 
-                                       Maze::Direction::Down, 
-                                       Maze::Direction::Right};
+        if (hasUnvisitedNeighbors(cell.first.x, cell.first.y, maze, unvisited)) {
+            std::array<Maze::Direction, 4> dirs {Maze::Direction::Up, 
+                                         Maze::Direction::Left, 
+                                         Maze::Direction::Down, 
+                                         Maze::Direction::Right};
 
             std::shuffle(std::begin(dirs), std::end(dirs), rng);
             
             for (Maze::Direction dir : dirs) {
-                if (!maze.isVisited(cell.first.x, cell.first.y, dir)) {
+                if (isUnvisitedNeighbour(maze, unvisited, cell.first.x, cell.first.y, dir)) {
                     maze.toggleWall(cell.first.x, cell.first.y, dir, renderer);
-                    cells.push_back(std::make_pair(changePosition(cell.first.x, cell.first.y, dir), dir));
+                    sf::Vector2u next = changePosition(cell.first.x, cell.first.y, dir);
+                    markVisited(maze, unvisited, next.x, next.y);
+                    cells.push_back(std::make_pair(next, dir));
                     update(window, renderer, delay);
                     break;
                 }
@@ -159,7 +285,11 @@ struct less {
     }
 };
 
-void printSets(std::map<unsigned int, std::vector<sf::Vector2u>>& sets) {
+// the cells of every set in the current row and the set of every cell, kept in the solver's scratch arena
+using CellSets = std::pmr::map<sf::Vector2u, unsigned int, less<unsigned int>>;
+using Sets = std::pmr::map<unsigned int, std::pmr::vector<sf::Vector2u>>;
+
+void printSets(Sets& sets) {
     std::cout << sets.size() << std::endl;
     for (const auto& [key, value] : sets) {
         std::cout << key << ": ";
@@ -168,7 +298,7 @@ void printSets(std::map<unsigned int, std::vector<sf::Vector2u>>& sets) {
     }
 }
 
-void mergeSets(std::map<sf::Vector2u, unsigned int, less<unsigned int>>& cellSets, std::map<unsigned int, std::vector<sf::Vector2u>>& sets, unsigned int set1, unsigned int set2) {
+void mergeSets(CellSets& cellSets, Sets& sets, unsigned int set1, unsigned int set2) {
     for (sf::Vector2u cell : sets.at(set2)) {
         cellSets.at(cell) = set1;
         sets.at(set1).push_back(cell);
@@ -178,65 +308,76 @@ void mergeSets(std::map<sf::Vector2u, unsigned int, less<unsigned int>>& cellSet
 }
 
 void MazeSolver::ellers(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
-    std::map<sf::Vector2u, unsigned int, less<unsigned int>> cellSets;
-    std::map<unsigned int, std::vector<sf::Vector2u>> sets;
+    CellSets cellSets(scratch.get());
+    Sets sets(scratch.get());
     int setCounter = 1;
+    int words = maze.getWordsPerRow();
+
+    // only active cells get a set and only walls between two of them are carved, both found a word at a time so the
+    // cells outside a mask are never looked at (fitToMask joins whatever pieces that leaves)
     for (int row = 0; row < maze.getSize().x; row++) {
-        for (int col = 0; col < maze.getSize().y; col++) {
-            if (cellSets.find(sf::Vector2u(row, col)) == cellSets.end()) {
-                cellSets.insert(std::make_pair(sf::Vector2u(row, col), setCounter));
-                
-                if (sets.find(setCounter) != sets.end())
-                    sets.at(setCounter).push_back(sf::Vector2u(row, col));
-                else sets.insert(std::make_pair(setCounter, std::vector {sf::Vector2u(row, col)}));
-
-                setCounter++;
+        for (int word = 0; word < words; word++) {
+            for (std::uint64_t active = maze.getActiveWord(row, word); active; active &= active - 1) {
+                int col = word * 64 + bits::countTrailingZeros(active);
+                if (cellSets.find(sf::Vector2u(row, col)) == cellSets.end()) {
+                    cellSets.insert(std::make_pair(sf::Vector2u(row, col), setCounter));
+
+                    // operator[] hands the arena on to a new set's vector
+                    sets[setCounter].push_back(sf::Vector2u(row, col));
+
+                    setCounter++;
+                }
             }
         }
 
-        for (int col = 0; col < maze.getSize().y - 1; col++) {
-            if (row != maze.getSize().x - 1 && irand(0, 100) > 50 && (cellSets.at(sf::Vector2u(row, col)) != cellSets.at(sf::Vector2u(row, col + 1))))  {
-                maze.toggleWall(row, col, Maze::Direction::Right, renderer);
-                mergeSets(cellSets, sets, cellSets.at(sf::Vector2u(row, col)), cellSets.at(sf::Vector2u(row, col + 1)));
-                update(window, renderer, delay);
-            }
-            else if (row == maze.getSize().x - 1) {
-                if (cellSets.at(sf::Vector2u(row, col)) != cellSets.at(sf::Vector2u(row, col + 1))) {
+        for (int word = 0; word < words; word++) {
+            for (std::uint64_t pairs = getRightKeep(maze, row, word); pairs; pairs &= pairs - 1) {
+                int col = word * 64 + bits::countTrailingZeros(pairs);
+                if (row != maze.getSize().x - 1 && irand(0, 100) > 50 && (cellSets.at(sf::Vector2u(row, col)) != cellSets.at(sf::Vector2u(row, col + 1))))  {
                     maze.toggleWall(row, col, Maze::Direction::Right, renderer);
                     mergeSets(cellSets, sets, cellSets.at(sf::Vector2u(row, col)), cellSets.at(sf::Vector2u(row, col + 1)));
                     update(window, renderer, delay);
                 }
+                else if (row == maze.getSize().x - 1) {
+                    if (cellSets.at(sf::Vector2u(row, col)) != cellSets.at(sf::Vector2u(row, col + 1))) {
+                        maze.toggleWall(row, col, Maze::Direction::Right, renderer);
+                        mergeSets(cellSets, sets, cellSets.at(sf::Vector2u(row, col)), cellSets.at(sf::Vector2u(row, col + 1)));
+                        update(window, renderer, delay);
+                    }
+                }
             }
         }
 
-        std::map<sf::Vector2u, unsigned int, less<unsigned int>> newCellSets;
-        std::map<unsigned int, std::vector<sf::Vector2u>> newSets;
+        CellSets newCellSets(scratch.get());
+        Sets newSets(scratch.get());
         if (row != maze.getSize().x - 1) {
             for (const auto& [key, value] : sets) {
                 int iters = irand(1, value.size());
                 for (int i = 0; i < iters; i++) {
+                    // a cell below outside the mask counts as visited, so a set can't go down into it
                     sf::Vector2u connection = value[irand(0, value.size() - 1)];
                     if (!maze.isVisited(row, connection.y, Maze::Direction::Down)) {
                         maze.toggleWall(row, connection.y, Maze::Direction::Down, renderer);
                         newCellSets.insert(std::make_pair(sf::Vector2u(row + 1, connection.y), key));
-                        if (newSets.find(key) != newSets.end())
-                            newSets.at(key).push_back(sf::Vector2u(row + 1, connection.y));
-                        else newSets.insert(std::make_pair(key, std::vector {sf::Vector2u(row + 1, connection.y)}));
+                        newSets[key].push_back(sf::Vector2u(row + 1, connection.y));
                         update(window, renderer, delay);
                     }
                 }
             }
         }
 
-        cellSets = newCellSets;
-        sets = newSets;
-
-        for (int col = 0; col < maze.getSize().y; col++) {
-            renderer.toggleCell(row * 2 + 1, col * 2 + 1, sf::Color::White);
-            if (col != maze.getSize().y - 1)
-                renderer.toggleIf(row * 2 + 1, col * 2 + 2, sf::Color::White, sf::Color(242, 94, 94));
-            if (row != maze.getSize().x - 1)
-                renderer.toggleIf(row * 2 + 2, col * 2 + 1, sf::Color::White, sf::Color(242, 94, 94));
+        cellSets = std::move(newCellSets);
+        sets = std::move(newSets);
+
+        for (int word = 0; word < words; word++) {
+            for (std::uint64_t active = maze.getActiveWord(row, word); active; active &= active - 1) {
+                int col = word * 64 + bits::countTrailingZeros(active);
+                renderer.toggleCell(row * 2 + 1, col * 2 + 1, sf::Color::White);
+                if (col != maze.getSize().y - 1)
+                    renderer.toggleIf(row * 2 + 1, col * 2 + 2, sf::Color::White, sf::Color(242, 94, 94));
+                if (row != maze.getSize().x - 1)
+                    renderer.toggleIf(row * 2 + 2, col * 2 + 1, sf::Color::White, sf::Color(242, 94, 94));
+            }
         }
     }
 }
@@ -250,34 +391,312 @@ void MazeSolver::recursiveDivision(Maze& maze, sf::RenderWindow& window, Rendere
     if ((width <= 0 && orientation) || (height <= 0 && !orientation))
         return;
 
+    // the maze starts with every wall between two active cells open (see Maze::removeWalls), so a slice only closes
+    // those and skips the rest, a slice that is all outside the mask isn't a step of the animation
     if (orientation) {
         // vertical slice
         int sliceCol = irand(col, col + width - 1);
         int gapIndex = irand(row, row + height);
+        bool active = false;
         for (int i = row; i < row + height + 1; i++) {
+            if (!((getRightKeep(maze, i, sliceCol / 64) >> (sliceCol % 64)) & 1))
+                continue;
+
+            active = true;
             if (i != gapIndex) 
                 maze.toggleWall(i, sliceCol, Maze::Direction::Right, renderer, sf::Color::White, sf::Color::Black);
             renderer.toggleWall(i * 2 + 2, sliceCol * 2 + 2, sf::Color::Black);
         }
 
-        if (width != 1) 
+        if (width != 1 && active) 
             update(window, renderer, delay);
         recursiveDivision(maze, window, renderer, delay, row, sliceCol + 1, width - (sliceCol - col + 1), height, pickOrientation(width - (sliceCol - col + 1), height));
         recursiveDivision(maze, window, renderer, delay, row, col, sliceCol - col, height, pickOrientation(sliceCol - col, height));
     }
     else {
-        // horizontal slice
+        // horizontal slice, along a row so whole words of it are skipped at once
         int sliceRow = irand(row, row + height - 1);
         int gapIndex  = irand(col, col + width);
-        for (int i = col; i < col + width + 1; i++) {
-            if (i != gapIndex)
-                maze.toggleWall(sliceRow, i, Maze::Direction::Down, renderer, sf::Color::White, sf::Color::Black);
-            renderer.toggleWall(sliceRow * 2 + 2, i * 2 + 2, sf::Color::Black);
+        bool active = false;
+        for (int word = col / 64; word <= (col + width) / 64; word++) {
+            std::uint64_t range = bits::lowMask(std::min(64, col + width + 1 - word * 64)) & ~bits::lowMask(std::max(0, col - word * 64));
+            for (std::uint64_t set = getDownKeep(maze, sliceRow, word) & range; set; set &= set - 1) {
+                int i = word * 64 + bits::countTrailingZeros(set);
+                active = true;
+                if (i != gapIndex)
+                    maze.toggleWall(sliceRow, i, Maze::Direction::Down, renderer, sf::Color::White, sf::Color::Black);
+                renderer.toggleWall(sliceRow * 2 + 2, i * 2 + 2, sf::Color::Black);
+            }
         }
 
-        if (height != 1) 
+        if (height != 1 && active) 
             update(window, renderer, delay);
         recursiveDivision(maze, window, renderer, delay, sliceRow + 1, col, width, height - (sliceRow - row + 1), pickOrientation(width, height - (sliceRow - row + 1)));
         recursiveDivision(maze, window, renderer, delay, row, col, width, sliceRow - row, pickOrientation(width, sliceRow - row));
     }
-}
\ No newline at end of file
+}
+
+std::uint64_t MazeSolver::getSeed() {
+    return ((std::uint64_t) gen() << 32) | gen();
+}
+
+void MazeSolver::reveal(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
+    for (int row = 0; row < maze.getSize().x; row++) {
+        for (int col = 0; col < maze.getSize().y; col++) {
+            renderer.toggleCell(row * 2 + 1, col * 2 + 1, sf::Color::White);
+            if (maze.isOpen(row, col, Maze::Direction::Up))
+                renderer.toggleWall(row * 2, col * 2 + 1, sf::Color::White);
+            if (maze.isOpen(row, col, Maze::Direction::Right))
+                renderer.toggleWall(row * 2 + 1, col * 2 + 2, sf::Color::White);
+        }
+        update(window, renderer, delay);
+    }
+}
+
+// these carve whole words at a time (see BulkGenerators.hpp) so the animation can only show the finished rows
+void MazeSolver::binaryTree(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
+    bulk::binaryTree(maze, getSeed(), 1);
+    reveal(maze, window, renderer, delay);
+}
+
+void MazeSolver::sidewinder(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
+    bulk::sidewinder(maze, getSeed(), 1);
+    reveal(maze, window, renderer, delay);
+}
+
+void MazeSolver::huntAndKill(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
+    int rows = maze.getSize().x;
+    int cols = maze.getSize().y;
+    int words = (cols + 63) / 64;
+
+    // one bit per cell that hasn't been visited yet and one bit per row that still has any, so neither the walk nor
+    // the hunt ever has to look at a visited cell (and there is no stack, unlike the recursive backtracker)
+    // cells outside a mask start out visited
+    std::pmr::vector<std::uint64_t> unvisited(scratch.get());
+    std::pmr::vector<std::uint64_t> pendingRows((rows + 63) / 64, 0, scratch.get());
+    fillUnvisited(maze, unvisited);
+    for (int row = 0; row < rows; row++) {
+        const std::uint64_t* rowWords = &unvisited[(std::size_t) row * words];
+        if (std::any_of(rowWords, rowWords + words, [](std::uint64_t word) { return word != 0; }))
+            pendingRows[row / 64] |= 1ull << (row % 64);
+    }
+
+    auto isUnvisited = [&](int row, int col) {
+        return row >= 0 && row < rows && col >= 0 && col < cols &&
+               ((unvisited[(std::size_t) row * words + col / 64] >> (col % 64)) & 1);
+    };
+
+    auto visit = [&](int row, int col) {
+        std::uint64_t* rowWords = &unvisited[(std::size_t) row * words];
+        rowWords[col / 64] &= ~(1ull << (col % 64));
+        if (rowWords[col / 64] == 0 && std::all_of(rowWords, rowWords + words, [](std::uint64_t word) { return word == 0; }))
+            pendingRows[row / 64] &= ~(1ull << (row % 64));
+    };
+
+    const Maze::Direction dirs[4] = {Maze::Direction::Up, Maze::Direction::Down, Maze::Direction::Left, Maze::Direction::Right};
+    auto getNeighbour = [](int row, int col, Maze::Direction dir) {
+        return sf::Vector2i(row + (dir == Maze::Direction::Down) - (dir == Maze::Direction::Up),
+                            col + (dir == Maze::Direction::Right) - (dir == Maze::Direction::Left));
+    };
+
+    sf::Vector2i cell(irand(0, rows - 1), irand(0, cols - 1));
+    if (!maze.isActive(cell.x, cell.y))
+        cell = sf::Vector2i(maze.getFirstActive());
+    visit(cell.x, cell.y);
+    renderer.toggleCell(cell.x * 2 + 1, cell.y * 2 + 1, sf::Color(242, 94, 94));
+    update(window, renderer, delay);
+
+    while (true) {
+        // kill: walk to random unvisited neighbours until there are none
+        Maze::Direction options[4];
+        int count = 0;
+        for (Maze::Direction dir : dirs) {
+            sf::Vector2i next = getNeighbour(cell.x, cell.y, dir);
+            if (isUnvisited(next.x, next.y))
+                options[count++] = dir;
+        }
+
+        if (count > 0) {
+            Maze::Direction dir = options[irand(0, count - 1)];
+            maze.toggleWall(cell.x, cell.y, dir, renderer, sf::Color::White, sf::Color::White);
+            cell = getNeighbour(cell.x, cell.y, dir);
+            visit(cell.x, cell.y);
+
+            renderer.toggleCell(cell.x * 2 + 1, cell.y * 2 + 1, sf::Color(242, 94, 94));
+            update(window, renderer, delay);
+            continue;
+        }
+        renderer.toggleCell(cell.x * 2 + 1, cell.y * 2 + 1, sf::Color::White);
+
+        // hunt: the first row with unvisited cells, every one of its cells has a visited cell above it (unless it's
+        // the top row or a mask is in the way) so the hunt rarely looks past it
+        int row = -1;
+        for (std::size_t i = 0; i < pendingRows.size(); i++) {
+            if (pendingRows[i]) {
+                row = (int) i * 64 + bits::countTrailingZeros(pendingRows[i]);
+                break;
+            }
+        }
+        if (row < 0)
+            break;
+
+        int col = -1;
+        for (; row < rows && col < 0; row++) {
+            const std::uint64_t* current = &unvisited[(std::size_t) row * words];
+            const std::uint64_t* above = row > 0 ? &unvisited[(std::size_t) (row - 1) * words] : nullptr;
+            const std::uint64_t* below = row < rows - 1 ? &unvisited[(std::size_t) (row + 1) * words] : nullptr;
+
+            for (int w = 0; w < words; w++) {
+                // visited cells are the active ones that aren't unvisited
+                std::uint64_t visited = ~current[w] & maze.getActiveWord(row, w);
+                std::uint64_t previous = w > 0 ? (~current[w - 1] & maze.getActiveWord(row, w - 1)) >> 63 : 0;
+                std::uint64_t next = w < words - 1 ? (~current[w + 1] & maze.getActiveWord(row, w + 1) & 1) << 63 : 0;
+
+                // unvisited cells with a visited neighbour on any side
+                std::uint64_t nearVisited = (visited << 1) | previous | (visited >> 1) | next;
+                if (above)
+                    nearVisited |= ~above[w] & maze.getActiveWord(row - 1, w);
+                if (below)
+                    nearVisited |= ~below[w] & maze.getActiveWord(row + 1, w);
+
+                std::uint64_t candidates = current[w] & nearVisited;
+                if (candidates) {
+                    col = w * 64 + bits::countTrailingZeros(candidates);
+                    break;
+                }
+            }
+        }
+        row--;
+
+        // whatever is left can't be reached from here (fitToMask joins it up)
+        if (col < 0)
+            break;
+
+        // join the found cell to one of its visited neighbours and carry on walking from it
+        count = 0;
+        for (Maze::Direction dir : dirs) {
+            sf::Vector2i next = getNeighbour(row, col, dir);
+            if (next.x >= 0 && next.x < rows && next.y >= 0 && next.y < cols && maze.isActive(next.x, next.y) &&
+                !isUnvisited(next.x, next.y))
+                options[count++] = dir;
+        }
+
+        cell = sf::Vector2i(row, col);
+        maze.toggleWall(row, col, options[irand(0, count - 1)], renderer, sf::Color::White, sf::Color::White);
+        visit(row, col);
+
+        renderer.toggleCell(row * 2 + 1, col * 2 + 1, sf::Color(242, 94, 94));
+        update(window, renderer, delay);
+    }
+}
+
+std::uint32_t findSet(std::pmr::vector<std::uint32_t>& parent, std::uint32_t x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// returns false if the cells were already in the same set
+bool uniteSets(std::pmr::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b) {
+    a = findSet(parent, a);
+    b = findSet(parent, b);
+    if (a == b)
+        return false;
+
+    parent[std::max(a, b)] = std::min(a, b);
+    return true;
+}
+
+void MazeSolver::fitToMask(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay) {
+    if (!maze.hasMask())
+        return;
+
+    PROFILE_SCOPE("MazeSolver::fitToMask");
+    int rows = maze.getSize().x;
+    int cols = maze.getSize().y;
+    int words = maze.getWordsPerRow();
+
+    // drop the passages that leave the mask (the word parallel generators carve without looking at the mask)
+    for (int row = 0; row < rows; row++) {
+        for (int word = 0; word < words; word++) {
+            std::uint64_t& right = maze.getRightWords(row)[word];
+            std::uint64_t& down = maze.getDownWords(row)[word];
+
+            for (std::uint64_t removed = right & ~getRightKeep(maze, row, word); removed; removed &= removed - 1)
+                renderer.toggleWall(row * 2 + 1, (word * 64 + bits::countTrailingZeros(removed)) * 2 + 2, sf::Color::Black);
+            for (std::uint64_t removed = down & ~getDownKeep(maze, row, word); removed; removed &= removed - 1)
+                renderer.toggleWall(row * 2 + 2, (word * 64 + bits::countTrailingZeros(removed)) * 2 + 1, sf::Color::Black);
+
+            right &= getRightKeep(maze, row, word);
+            down &= getDownKeep(maze, row, word);
+        }
+    }
+
+    // only the active cells are numbered for the union find, the number of a cell is the number of active cells in
+    // front of its word plus the ones in front of it inside the word
+    std::pmr::vector<std::uint32_t> firstNumber((std::size_t) rows * words, scratch.get());
+    std::uint32_t count = 0;
+    for (int row = 0; row < rows; row++) {
+        for (int word = 0; word < words; word++) {
+            firstNumber[(std::size_t) row * words + word] = count;
+            count += bits::popcount(maze.getMaskWords(row)[word]);
+        }
+    }
+    auto getNumber = [&](int row, int col) {
+        std::uint64_t before = maze.getMaskWords(row)[col / 64] & bits::lowMask(col % 64);
+        return firstNumber[(std::size_t) row * words + col / 64] + (std::uint32_t) bits::popcount(before);
+    };
+
+    // find the pieces that are left
+    std::pmr::vector<std::uint32_t> parent(count, scratch.get());
+    for (std::uint32_t i = 0; i < parent.size(); i++)
+        parent[i] = i;
+
+    std::uint64_t pieces = count;
+    for (int row = 0; row < rows; row++) {
+        for (int word = 0; word < words; word++) {
+            for (std::uint64_t set = maze.getRightWords(row)[word]; set; set &= set - 1) {
+                int col = word * 64 + bits::countTrailingZeros(set);
+                pieces -= uniteSets(parent, getNumber(row, col), getNumber(row, col + 1));
+            }
+            for (std::uint64_t set = maze.getDownWords(row)[word]; set; set &= set - 1) {
+                int col = word * 64 + bits::countTrailingZeros(set);
+                pieces -= uniteSets(parent, getNumber(row, col), getNumber(row + 1, col));
+            }
+        }
+    }
+
+    if (pieces <= 1)
+        return;
+
+    // every closed wall between two active cells (cell * 2, plus one for the wall below the cell) in random order
+    std::pmr::vector<std::uint64_t> walls(scratch.get());
+    for (int row = 0; row < rows; row++) {
+        for (int word = 0; word < words; word++) {
+            std::uint64_t base = (std::uint64_t) row * cols + word * 64;
+            for (std::uint64_t set = getRightKeep(maze, row, word) & ~maze.getRightWords(row)[word]; set; set &= set - 1)
+                walls.push_back((base + bits::countTrailingZeros(set)) * 2);
+            for (std::uint64_t set = getDownKeep(maze, row, word) & ~maze.getDownWords(row)[word]; set; set &= set - 1)
+                walls.push_back((base + bits::countTrailingZeros(set)) * 2 + 1);
+        }
+    }
+    std::shuffle(walls.begin(), walls.end(), rng);
+
+    for (std::uint64_t wall : walls) {
+        std::uint32_t cell = (std::uint32_t) (wall / 2);
+        int row = cell / cols;
+        int col = cell % cols;
+        bool isDown = wall & 1;
+        if (!uniteSets(parent, getNumber(row, col), isDown ? getNumber(row + 1, col) : getNumber(row, col + 1)))
+            continue;
+
+        maze.toggleWall(row, col, isDown ? Maze::Direction::Down : Maze::Direction::Right, renderer,
+                        sf::Color::White, sf::Color::White);
+        update(window, renderer, delay);
+
+        if (--pieces == 1)
+            break;
+    }
+}
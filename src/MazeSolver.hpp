@@ -1,8 +1,10 @@
 #ifndef MAZE_SOLVERS_HPP
 #define MAZE_SOLVERS_HPP
 
+#include <atomic>
 #include <random>
 #include <iostream>
+#include <cstdint>
 
 class Renderer;
 class MazeSolver;
@@ -10,56 +12,117 @@ class MazeSolver;
 #include <SFML/Graphics.hpp>
 
 #include "Maze.hpp"
+#include "Profiler.hpp"
+#include "Arena.hpp"
 
 // template hell just so that I only have one wrapper function to unactivate the window after the recursion finishes
 template <class T, class F, class... Params>
 static void start(T algo, F& obj, Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay, Params&&... params) {
-    (obj.*algo)(maze, window, renderer, delay, std::forward<Params>(params)...);
+    {
+        PROFILE_SCOPE("generate");
+        (obj.*algo)(maze, window, renderer, delay, std::forward<Params>(params)...);
+        obj.fitToMask(maze, window, renderer, delay);
+    }
     window.setActive(false);
 }
  
 class MazeSolver {
 public:
+    // bump whenever a change to a generator changes the maze it makes for a seed (cached mazes depend on it)
+    static constexpr int version = 1;
+
     MazeSolver();
 
+    // seeded solver, the same seed always produces the same maze
+    MazeSolver(unsigned int seed);
+
+    void seed(unsigned int seed);
+
     void recursiveBacktrack(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay, int row, int col, Maze::Direction dir);
     void growingTree(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
     void ellers(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
     void recursiveDivision(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay, int row, int col, int width, int height, bool orientation);
+    void binaryTree(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
+    void sidewinder(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
+    void huntAndKill(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
 
     void update(sf::RenderWindow& window, Renderer& renderer, int delay);
 
+    // on a masked maze drops every passage that leaves the mask and joins whatever pieces the generator left
+    // (walls between them are opened in random order, like kruskal's algorithm) so the active cells form a perfect
+    // maze, does nothing without a mask
+    void fitToMask(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
+
+    // number of animation steps (calls to update) so far, safe to read from another thread
+    std::uint64_t getSteps() const;
+
+    // stops sleeping between steps so a running animation finishes as fast as it can
+    void skipDelay();
+
     int irand(int min, int max);
 
     enum class Algorithm {
         RecursiveBacktrack,
         GrowingTree,
         Ellers,
-        RecursiveDivision
+        RecursiveDivision,
+        BinaryTree,
+        Sidewinder,
+        HuntAndKill
     };
 
+    // runs the algorithm without a window or any delay, the maze must be freshly initialized
+    void generate(Maze& maze, Algorithm algo);
+
+    // throws away the scratch memory of the last run (generate does this by itself), keep calling the generators
+    // directly without it and the scratch keeps growing
+    void resetScratch();
+
 private:
+    // the recursion of recursiveBacktrack, unvisited has a bit for every cell that can still be carved into
+    void backtrackFrom(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay, std::pmr::vector<std::uint64_t>& unvisited, int row, int col, Maze::Direction dir);
+
     Maze::Direction getRandomDir();
-    std::pair<sf::Vector2u, Maze::Direction> getCell(std::vector<std::pair<sf::Vector2u, Maze::Direction>>& cells);
+    std::pair<sf::Vector2u, Maze::Direction> getCell(std::pmr::vector<std::pair<sf::Vector2u, Maze::Direction>>& cells);
     bool pickOrientation(int width, int height);
+    std::uint64_t getSeed();
+
+    // draws a maze that was carved without the renderer one row at a time
+    void reveal(Maze& maze, sf::RenderWindow& window, Renderer& renderer, int delay);
+
+    std::atomic<std::uint64_t> steps {0};
+    std::atomic<bool> skippingDelay {false};
+
+    // stacks, frontiers and set tables of the generators, reused from run to run
+    Arena scratch;
 
     std::random_device rd;
     std::default_random_engine rng;
     std::mt19937 gen{ rd() };
 };
 
-static void printAlgo(MazeSolver::Algorithm algo) {
+static const char* getAlgoName(MazeSolver::Algorithm algo) {
     switch (algo) {
         case MazeSolver::Algorithm::RecursiveBacktrack:
-            std::cout << "Backtrack" << std::endl;
-            break;
+            return "Backtrack";
         case MazeSolver::Algorithm::GrowingTree:
-            std::cout << "Growing Tree" << std::endl;
-            break;
+            return "Growing Tree";
         case MazeSolver::Algorithm::Ellers:
-            std::cout << "Ellers" << std::endl;
-            break;
+            return "Ellers";
+        case MazeSolver::Algorithm::RecursiveDivision:
+            return "Recursive Division";
+        case MazeSolver::Algorithm::BinaryTree:
+            return "Binary Tree";
+        case MazeSolver::Algorithm::Sidewinder:
+            return "Sidewinder";
+        case MazeSolver::Algorithm::HuntAndKill:
+            return "Hunt and Kill";
     }
+    return "";
+}
+
+static void printAlgo(MazeSolver::Algorithm algo) {
+    std::cout << getAlgoName(algo) << std::endl;
 }
 
 #endif /* MAZE_SOLVERS_HPP */
\ No newline at end of file
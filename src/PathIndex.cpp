@@ -0,0 +1,649 @@
+#include "PathIndex.hpp"
+#include "IncrementalSolver.hpp"
+#include "MazeCache.hpp"
+#include "MazeSolver.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// distance marker for cells (and entrances) that can't be reached
+constexpr std::uint16_t unreachable = 0xFFFF;
+
+// parent marker for entrances reached straight from the start, and lastEntrance for a path inside one cluster
+constexpr std::uint32_t noEntrance = 0xFFFFFFFF;
+
+// the local searches index cells with 16 bits and the cached distances have to fit in 16 bits
+constexpr int minClusterSize = 2;
+constexpr int maxClusterSize = 128;
+
+// exits of a cell as bit flags
+constexpr std::uint8_t exitUp = 1;
+constexpr std::uint8_t exitDown = 2;
+constexpr std::uint8_t exitLeft = 4;
+constexpr std::uint8_t exitRight = 8;
+
+PathIndex::PathIndex(const Maze& maze, int clusterSize) : maze(maze), clusterSize(std::max(minClusterSize, std::min(clusterSize, maxClusterSize))) {}
+
+int PathIndex::getClusterSize() const {
+    return clusterSize;
+}
+
+std::size_t PathIndex::getEntranceCount() const {
+    std::size_t count = 0;
+    for (const Cluster& cluster : clusters)
+        count += cluster.entrances.size();
+
+    return count;
+}
+
+std::size_t PathIndex::memoryUsage() const {
+    std::size_t bytes = sizeof(PathIndex) + clusters.capacity() * sizeof(Cluster);
+    for (const Cluster& cluster : clusters)
+        bytes += (cluster.entrances.capacity() + cluster.offsets.capacity()) * sizeof(std::uint32_t) +
+                 (cluster.targets.capacity() + cluster.lengths.capacity()) * sizeof(std::uint16_t);
+
+    bytes += (firstEntrance.capacity() + entranceCluster.capacity() + parents.capacity() + stamps.capacity()) * sizeof(std::uint32_t);
+    bytes += costs.capacity() * sizeof(std::uint64_t);
+    return bytes;
+}
+
+int PathIndex::getCluster(std::uint32_t cell) const {
+    return (int) (cell / cols / clusterSize) * clusterCols + (int) (cell % cols / clusterSize);
+}
+
+sf::IntRect PathIndex::getBounds(int cluster) const {
+    int top = cluster / clusterCols * clusterSize;
+    int left = cluster % clusterCols * clusterSize;
+
+    return sf::IntRect(left, top, std::min(clusterSize, cols - left), std::min(clusterSize, rows - top));
+}
+
+int PathIndex::getLocal(std::uint32_t cell, const Scratch& scratch) const {
+    return ((int) (cell / cols) - scratch.top) * scratch.width + (int) (cell % cols) - scratch.left;
+}
+
+void PathIndex::loadExits(int cluster, Scratch& scratch) const {
+    sf::IntRect bounds = getBounds(cluster);
+    scratch.left = bounds.left;
+    scratch.top = bounds.top;
+    scratch.width = bounds.width;
+    scratch.height = bounds.height;
+    scratch.exits.resize(bounds.width * bounds.height);
+
+    // straight from the bitmaps, passages out of the cluster are masked off at its edges
+    auto getBit = [](const std::uint64_t* words, int col) {
+        return (std::uint8_t) ((words[col / 64] >> (col % 64)) & 1);
+    };
+
+    for (int r = 0; r < bounds.height; r++) {
+        const std::uint64_t* right = maze.getRightWords(bounds.top + r);
+        const std::uint64_t* down = maze.getDownWords(bounds.top + r);
+        const std::uint64_t* up = r > 0 ? maze.getDownWords(bounds.top + r - 1) : nullptr;
+        bool last = r == bounds.height - 1;
+
+        std::uint8_t left = 0;
+        for (int c = 0; c < bounds.width; c++) {
+            int col = bounds.left + c;
+            std::uint8_t open = c < bounds.width - 1 ? getBit(right, col) : 0;
+
+            scratch.exits[r * bounds.width + c] = (up ? getBit(up, col) * exitUp : 0) | (last ? 0 : getBit(down, col) * exitDown) |
+                                                  left * exitLeft | open * exitRight;
+            left = open;
+        }
+    }
+}
+
+void PathIndex::search(std::uint32_t cell, Scratch& scratch, bool passing) const {
+    int width = scratch.width;
+    scratch.distances.assign(scratch.exits.size(), unreachable);
+    scratch.queue.resize(scratch.exits.size());
+    if (passing)
+        scratch.passed.assign(scratch.exits.size(), 0);
+
+    int start = getLocal(cell, scratch);
+    scratch.distances[start] = 0;
+    scratch.queue[0] = (std::uint16_t) start;
+
+    std::size_t head = 0;
+    std::size_t tail = 1;
+    while (head < tail) {
+        int local = scratch.queue[head++];
+        std::uint16_t next = scratch.distances[local] + 1;
+        std::uint8_t exits = scratch.exits[local];
+        std::uint8_t passed = passing && (scratch.passed[local] || (local != start && scratch.entrances[local] != unreachable));
+
+        int neighbours[4] = {local - width, local + width, local - 1, local + 1};
+        for (int i = 0; i < 4; i++) {
+            if ((exits & (1 << i)) && scratch.distances[neighbours[i]] == unreachable) {
+                scratch.distances[neighbours[i]] = next;
+                scratch.queue[tail++] = (std::uint16_t) neighbours[i];
+                if (passing)
+                    scratch.passed[neighbours[i]] = passed;
+            }
+        }
+    }
+}
+
+void PathIndex::buildCluster(int cluster, Scratch& scratch) {
+    sf::IntRect bounds = getBounds(cluster);
+    Cluster& c = clusters[cluster];
+    c.entrances.clear();
+
+    // cells on the border with a passage out of the cluster
+    auto check = [&](int row, int col) {
+        if ((row == bounds.top && maze.isOpen(row, col, Maze::Direction::Up)) ||
+            (row == bounds.top + bounds.height - 1 && maze.isOpen(row, col, Maze::Direction::Down)) ||
+            (col == bounds.left && maze.isOpen(row, col, Maze::Direction::Left)) ||
+            (col == bounds.left + bounds.width - 1 && maze.isOpen(row, col, Maze::Direction::Right)))
+            c.entrances.push_back((std::uint32_t) row * cols + col);
+    };
+    for (int col = bounds.left; col < bounds.left + bounds.width; col++) {
+        check(bounds.top, col);
+        check(bounds.top + bounds.height - 1, col);
+    }
+    for (int row = bounds.top + 1; row < bounds.top + bounds.height - 1; row++) {
+        check(row, bounds.left);
+        check(row, bounds.left + bounds.width - 1);
+    }
+
+    std::sort(c.entrances.begin(), c.entrances.end());
+    c.entrances.erase(std::unique(c.entrances.begin(), c.entrances.end()), c.entrances.end());
+
+    std::size_t count = c.entrances.size();
+    loadExits(cluster, scratch);
+    scratch.entrances.assign(scratch.exits.size(), unreachable);
+    for (std::size_t i = 0; i < count; i++)
+        scratch.entrances[getLocal(c.entrances[i], scratch)] = (std::uint16_t) i;
+
+    // link every entrance to the ones it reaches without passing another one
+    c.offsets.clear();
+    c.targets.clear();
+    c.lengths.clear();
+    for (std::size_t i = 0; i < count; i++) {
+        c.offsets.push_back((std::uint32_t) c.targets.size());
+        search(c.entrances[i], scratch, true);
+        for (std::size_t j = 0; j < count; j++) {
+            int local = getLocal(c.entrances[j], scratch);
+            if (j != i && scratch.distances[local] != unreachable && !scratch.passed[local]) {
+                c.targets.push_back((std::uint16_t) j);
+                c.lengths.push_back(scratch.distances[local]);
+            }
+        }
+    }
+    c.offsets.push_back((std::uint32_t) c.targets.size());
+}
+
+void PathIndex::build(int threads) {
+    rows = maze.getSize().x;
+    cols = maze.getSize().y;
+    clusterRows = (rows + clusterSize - 1) / clusterSize;
+    clusterCols = (cols + clusterSize - 1) / clusterSize;
+    clusters.resize((std::size_t) clusterRows * clusterCols);
+
+    // one contiguous range of clusters per thread, each with its own scratch buffers
+    int count = (int) clusters.size();
+    threads = std::max(1, std::min(threads, count));
+    int perThread = (count + threads - 1) / threads;
+
+    auto buildRange = [this, count, perThread](int t, Scratch& scratch) {
+        for (int cluster = t * perThread; cluster < std::min(count, (t + 1) * perThread); cluster++)
+            buildCluster(cluster, scratch);
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<Scratch> scratches(threads - 1);
+    for (int t = 1; t < threads; t++)
+        workers.emplace_back(buildRange, t, std::ref(scratches[t - 1]));
+    buildRange(0, scratch);
+    for (std::thread& worker : workers)
+        worker.join();
+
+    numbered = false;
+}
+
+void PathIndex::update(const int row, const int col, Maze::Direction dir) {
+    if (row < 0 || col < 0 || row >= rows || col >= cols)
+        return;
+
+    int cluster = getCluster((std::uint32_t) row * cols + col);
+    buildCluster(cluster, scratch);
+
+    int otherRow = row + (dir == Maze::Direction::Down) - (dir == Maze::Direction::Up);
+    int otherCol = col + (dir == Maze::Direction::Right) - (dir == Maze::Direction::Left);
+    if (otherRow >= 0 && otherCol >= 0 && otherRow < rows && otherCol < cols) {
+        int other = getCluster((std::uint32_t) otherRow * cols + otherCol);
+        if (other != cluster)
+            buildCluster(other, scratch);
+    }
+
+    numbered = false;
+}
+
+bool PathIndex::isDeadEnd(int cluster, int entrance) const {
+    const Cluster& c = clusters[cluster];
+    if (c.offsets[entrance] != c.offsets[entrance + 1])
+        return false;
+
+    // a corner cell can still lead straight on into another cluster
+    std::uint32_t cell = c.entrances[entrance];
+    int row = cell / cols;
+    int col = cell % cols;
+    int crossings = (row > 0 && getCluster(cell - cols) != cluster && maze.isOpen(row, col, Maze::Direction::Up)) +
+                    (row < rows - 1 && getCluster(cell + cols) != cluster && maze.isOpen(row, col, Maze::Direction::Down)) +
+                    (col > 0 && getCluster(cell - 1) != cluster && maze.isOpen(row, col, Maze::Direction::Left)) +
+                    (col < cols - 1 && getCluster(cell + 1) != cluster && maze.isOpen(row, col, Maze::Direction::Right));
+    return crossings < 2;
+}
+
+int PathIndex::findEntrance(int cluster, std::uint32_t cell) const {
+    const std::vector<std::uint32_t>& entrances = clusters[cluster].entrances;
+    auto it = std::lower_bound(entrances.begin(), entrances.end(), cell);
+    return (it != entrances.end() && *it == cell) ? (int) (it - entrances.begin()) : -1;
+}
+
+void PathIndex::number() {
+    firstEntrance.resize(clusters.size() + 1);
+    entranceCluster.clear();
+
+    std::uint32_t total = 0;
+    for (std::size_t c = 0; c < clusters.size(); c++) {
+        firstEntrance[c] = total;
+        total += (std::uint32_t) clusters[c].entrances.size();
+        entranceCluster.resize(total, (std::uint32_t) c);
+    }
+    firstEntrance[clusters.size()] = total;
+
+    costs.resize(total);
+    parents.resize(total);
+    stamps.assign(total, 0);
+    stamp = 0;
+    numbered = true;
+}
+
+std::int64_t PathIndex::searchAbstract(sf::Vector2u start, sf::Vector2u goal) {
+    if (clusters.empty() || start.x >= (unsigned int) rows || start.y >= (unsigned int) cols ||
+        goal.x >= (unsigned int) rows || goal.y >= (unsigned int) cols)
+        return -1;
+
+    if (!numbered)
+        number();
+    if (++stamp == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+
+    std::uint32_t startCell = start.x * cols + start.y;
+    std::uint32_t goalCell = goal.x * cols + goal.y;
+    int startCluster = getCluster(startCell);
+    int goalCluster = getCluster(goalCell);
+
+    // the goal cluster first, its search also gives the path that never leaves the cluster if both are in it
+    std::uint64_t best = ~0ull;
+    lastEntrance = noEntrance;
+
+    const Cluster& last = clusters[goalCluster];
+    loadExits(goalCluster, scratch);
+    search(goalCell, scratch);
+    goalDistances.resize(last.entrances.size());
+    for (std::size_t i = 0; i < last.entrances.size(); i++)
+        goalDistances[i] = scratch.distances[getLocal(last.entrances[i], scratch)];
+    if (startCluster == goalCluster && scratch.distances[getLocal(startCell, scratch)] != unreachable)
+        best = scratch.distances[getLocal(startCell, scratch)];
+
+    const Cluster& first = clusters[startCluster];
+    loadExits(startCluster, scratch);
+    search(startCell, scratch);
+    startDistances.resize(first.entrances.size());
+    for (std::size_t i = 0; i < first.entrances.size(); i++)
+        startDistances[i] = scratch.distances[getLocal(first.entrances[i], scratch)];
+
+    // manhattan distance never overestimates in a grid, and it's consistent so entrances are never reopened
+    auto estimate = [&](std::uint32_t cell) {
+        std::int64_t dr = (std::int64_t) (cell / cols) - goal.x;
+        std::int64_t dc = (std::int64_t) (cell % cols) - goal.y;
+        return (std::uint64_t) ((dr < 0 ? -dr : dr) + (dc < 0 ? -dc : dc));
+    };
+
+    heap.clear();
+    auto relax = [&](std::uint32_t node, std::uint32_t cell, std::uint64_t cost, std::uint32_t parent) {
+        if (stamps[node] == stamp && costs[node] <= cost)
+            return;
+
+        stamps[node] = stamp;
+        costs[node] = cost;
+        parents[node] = parent;
+        heap.push_back(Open {cost + estimate(cell), node});
+        std::push_heap(heap.begin(), heap.end(), std::greater<Open>());
+    };
+
+    for (std::size_t i = 0; i < first.entrances.size(); i++)
+        if (startDistances[i] != unreachable)
+            relax(firstEntrance[startCluster] + (std::uint32_t) i, first.entrances[i], startDistances[i], noEntrance);
+
+    while (!heap.empty()) {
+        Open open = heap.front();
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Open>());
+        heap.pop_back();
+        if (open.estimate >= best)
+            break;
+
+        std::uint32_t node = open.node;
+        int c = (int) entranceCluster[node];
+        const Cluster& cluster = clusters[c];
+        std::size_t i = node - firstEntrance[c];
+        std::uint32_t cell = cluster.entrances[i];
+        std::uint64_t cost = costs[node];
+
+        // stale entry, the entrance was reached more cheaply after this was pushed
+        if (open.estimate != cost + estimate(cell))
+            continue;
+
+        if (c == goalCluster && goalDistances[i] != unreachable && cost + goalDistances[i] < best) {
+            best = cost + goalDistances[i];
+            lastEntrance = node;
+        }
+
+        // across the cluster
+        for (std::uint32_t link = cluster.offsets[i]; link < cluster.offsets[i + 1]; link++) {
+            std::uint16_t j = cluster.targets[link];
+            relax(firstEntrance[c] + j, cluster.entrances[j], cost + cluster.lengths[link], node);
+        }
+
+        // through the border passages into the neighbouring clusters
+        int row = cell / cols;
+        int col = cell % cols;
+        std::uint32_t neighbours[4] = {cell - cols, cell + cols, cell - 1, cell + 1};
+        Maze::Direction dirs[4] = {Maze::Direction::Up, Maze::Direction::Down, Maze::Direction::Left, Maze::Direction::Right};
+        for (int d = 0; d < 4; d++) {
+            if (!maze.isOpen(row, col, dirs[d]))
+                continue;
+
+            int other = getCluster(neighbours[d]);
+            if (other == c)
+                continue;
+
+            int j = findEntrance(other, neighbours[d]);
+            if (j >= 0 && (other == goalCluster || !isDeadEnd(other, j)))
+                relax(firstEntrance[other] + j, neighbours[d], cost + 1, node);
+        }
+    }
+
+    return best == ~0ull ? -1 : (std::int64_t) best;
+}
+
+bool PathIndex::refine(int cluster, std::uint32_t from, std::uint32_t to, std::vector<sf::Vector2u>& path) {
+    loadExits(cluster, scratch);
+    search(to, scratch);
+
+    // walk downhill on the distances to the target, an unreachable cell has no neighbour one step closer
+    int width = scratch.width;
+    int local = getLocal(from, scratch);
+    while (scratch.distances[local] != 0) {
+        std::uint8_t exits = scratch.exits[local];
+        int neighbours[4] = {local - width, local + width, local - 1, local + 1};
+        int next = -1;
+        for (int i = 0; i < 4 && next < 0; i++)
+            if ((exits & (1 << i)) && scratch.distances[neighbours[i]] + 1 == scratch.distances[local])
+                next = neighbours[i];
+
+        if (next < 0)
+            return false;
+        local = next;
+        path.push_back(sf::Vector2u(scratch.top + local / width, scratch.left + local % width));
+    }
+
+    return true;
+}
+
+std::uint64_t PathIndex::hashMaze() const {
+    int mazeRows = (int) maze.getSize().x;
+    std::uint64_t hash = rnd::hashCombine(mazeRows, maze.getSize().y);
+    for (int row = 0; row < mazeRows; row++) {
+        const std::uint64_t* right = maze.getRightWords(row);
+        const std::uint64_t* down = maze.getDownWords(row);
+        for (int word = 0; word < maze.getWordsPerRow(); word++)
+            hash = rnd::hashCombine(rnd::hashCombine(hash, right[word]), down[word]);
+    }
+
+    return hash;
+}
+
+std::int64_t PathIndex::getDistance(sf::Vector2u start, sf::Vector2u goal) {
+    return searchAbstract(start, goal);
+}
+
+bool PathIndex::findPath(sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path) {
+    path.clear();
+    if (searchAbstract(start, goal) < 0)
+        return false;
+
+    std::uint32_t startCell = start.x * cols + start.y;
+    std::uint32_t goalCell = goal.x * cols + goal.y;
+
+    // entrances on the path from the goal back to the start
+    std::vector<std::uint32_t> entrances;
+    for (std::uint32_t node = lastEntrance; node != noEntrance; node = parents[node])
+        entrances.push_back(node);
+    std::reverse(entrances.begin(), entrances.end());
+
+    path.push_back(start);
+    std::uint32_t cell = startCell;
+    for (std::uint32_t node : entrances) {
+        int c = (int) entranceCluster[node];
+        std::uint32_t next = clusters[c].entrances[node - firstEntrance[c]];
+
+        // consecutive entrances in different clusters are the two sides of a border passage
+        if (getCluster(cell) == c) {
+            if (!refine(c, cell, next, path)) {
+                path.clear();
+                return false;
+            }
+        }
+        else path.push_back(sf::Vector2u(next / cols, next % cols));
+        cell = next;
+    }
+
+    if (!refine(getCluster(goalCell), cell, goalCell, path)) {
+        path.clear();
+        return false;
+    }
+    return true;
+}
+
+void PathIndex::appendBinary(std::string& out) const {
+    std::uint32_t header[4] = {(std::uint32_t) clusterSize, (std::uint32_t) rows, (std::uint32_t) cols, (std::uint32_t) clusters.size()};
+    std::uint64_t hash = hashMaze();
+    out.append("HPAI", 4);
+    out.append(reinterpret_cast<const char*>(header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(&hash), sizeof(hash));
+
+    for (const Cluster& cluster : clusters) {
+        std::uint32_t counts[2] = {(std::uint32_t) cluster.entrances.size(), (std::uint32_t) cluster.targets.size()};
+        out.append(reinterpret_cast<const char*>(counts), sizeof(counts));
+        out.append(reinterpret_cast<const char*>(cluster.entrances.data()), counts[0] * sizeof(std::uint32_t));
+        out.append(reinterpret_cast<const char*>(cluster.offsets.data()), (counts[0] + 1) * sizeof(std::uint32_t));
+        out.append(reinterpret_cast<const char*>(cluster.targets.data()), counts[1] * sizeof(std::uint16_t));
+        out.append(reinterpret_cast<const char*>(cluster.lengths.data()), counts[1] * sizeof(std::uint16_t));
+    }
+}
+
+bool PathIndex::readBinary(const char* data, const std::size_t size) {
+    std::uint32_t header[4];
+    std::uint64_t hash;
+    if (size < 4 + sizeof(header) + sizeof(hash) || std::memcmp(data, "HPAI", 4) != 0)
+        return false;
+    std::memcpy(header, data + 4, sizeof(header));
+    std::memcpy(&hash, data + 4 + sizeof(header), sizeof(hash));
+
+    int newClusterSize = (int) header[0];
+    int newRows = (int) maze.getSize().x;
+    int newCols = (int) maze.getSize().y;
+    if (newClusterSize < minClusterSize || newClusterSize > maxClusterSize || header[1] != (std::uint32_t) newRows ||
+        header[2] != (std::uint32_t) newCols)
+        return false;
+
+    int newClusterRows = (newRows + newClusterSize - 1) / newClusterSize;
+    int newClusterCols = (newCols + newClusterSize - 1) / newClusterSize;
+    if (header[3] != (std::uint32_t) newClusterRows * newClusterCols)
+        return false;
+
+    // the same size isn't enough, the links of an index built for other passages lead through walls
+    if (hash != hashMaze())
+        return false;
+
+    // read everything into new clusters first so a bad file leaves the index as it was
+    std::vector<Cluster> loaded(header[3]);
+    std::size_t offset = 4 + sizeof(header) + sizeof(hash);
+    auto read = [&](auto& values, std::size_t count) {
+        std::size_t bytes = count * sizeof(values[0]);
+        if (size - offset < bytes)
+            return false;
+
+        values.resize(count);
+        if (bytes > 0)
+            std::memcpy(values.data(), data + offset, bytes);
+        offset += bytes;
+        return true;
+    };
+
+    for (Cluster& cluster : loaded) {
+        std::uint32_t counts[2];
+        if (size - offset < sizeof(counts))
+            return false;
+        std::memcpy(counts, data + offset, sizeof(counts));
+        offset += sizeof(counts);
+
+        if (counts[0] > (std::uint32_t) newClusterSize * 4 || counts[1] > counts[0] * counts[0] ||
+            !read(cluster.entrances, counts[0]) || !read(cluster.offsets, counts[0] + 1) ||
+            !read(cluster.targets, counts[1]) || !read(cluster.lengths, counts[1]))
+            return false;
+
+        // anything out of range would make queries read past the end of the arrays
+        for (std::uint32_t cell : cluster.entrances)
+            if (cell >= (std::uint32_t) newRows * newCols)
+                return false;
+        for (std::uint16_t target : cluster.targets)
+            if (target >= counts[0])
+                return false;
+        for (std::uint32_t i = 0; i < counts[0]; i++)
+            if (cluster.offsets[i] > cluster.offsets[i + 1])
+                return false;
+        if (cluster.offsets[0] != 0 || cluster.offsets[counts[0]] != counts[1])
+            return false;
+    }
+    if (offset != size)
+        return false;
+
+    clusterSize = newClusterSize;
+    rows = newRows;
+    cols = newCols;
+    clusterRows = newClusterRows;
+    clusterCols = newClusterCols;
+    clusters = std::move(loaded);
+    numbered = false;
+    return true;
+}
+
+namespace hpa {
+    // a random cell of a size x size maze
+    static sf::Vector2u randomCell(std::uint64_t value, int size) {
+        return sf::Vector2u(rnd::bounded(value, size), rnd::bounded(value << 32, size));
+    }
+
+    // see header
+    void benchmark(int size, int threads, std::uint64_t seed, MazeCache* cache) {
+        using Clock = std::chrono::steady_clock;
+
+        // made the way a sidewinder request to the server makes it, so the cache is shared with the server's mazes
+        constexpr MazeSolver::Algorithm algo = MazeSolver::Algorithm::Sidewinder;
+        std::uint32_t mazeSeed = (std::uint32_t) seed;
+
+        std::cout << "Indexing a " << size << "x" << size << " maze on " << threads << " threads (seed " << mazeSeed << ")" << std::endl;
+        Maze maze(size, size);
+        if (!cache || !cache->load(algo, size, size, mazeSeed, maze)) {
+            MazeSolver(mazeSeed).generate(maze, algo);
+            if (cache)
+                cache->store(algo, size, size, mazeSeed, maze);
+        }
+
+        auto begin = Clock::now();
+        PathIndex index(maze);
+        bool loaded = cache && cache->loadIndex(algo, size, size, mazeSeed, index);
+        if (!loaded)
+            index.build(threads);
+        double buildTime = std::chrono::duration<double>(Clock::now() - begin).count();
+        std::cout << (loaded ? "  load:    " : "  build:   ") << buildTime << "s, " << index.getEntranceCount() << " entrances, "
+                  << index.memoryUsage() / (1 << 20) << "MB" << std::endl;
+
+        // the binary form has to load back into an index for the same maze
+        std::string binary;
+        index.appendBinary(binary);
+        PathIndex copy(maze);
+        if (!copy.readBinary(binary.data(), binary.size()) || copy.getEntranceCount() != index.getEntranceCount())
+            std::cout << "  the index didn't load back from its binary form" << std::endl;
+        if (cache && !loaded)
+            cache->storeIndex(algo, size, size, mazeSeed, index);
+
+        // random queries, every one checked against a full breadth first search
+        constexpr int queries = 20;
+        IncrementalSolver solver(maze, sf::Vector2u(0, 0), sf::Vector2u(0, 0));
+        std::vector<sf::Vector2u> path;
+        auto compare = [&](std::uint64_t round, double& indexTime, double& searchTime) {
+            int mismatches = 0;
+            for (int i = 0; i < queries; i++) {
+                std::uint64_t value = rnd::hashCombine(rnd::hashCombine(seed, round), i);
+                sf::Vector2u start = randomCell(value, size);
+                sf::Vector2u goal = randomCell(rnd::hashCombine(value, i), size);
+
+                auto t0 = Clock::now();
+                index.findPath(start, goal, path);
+                auto t1 = Clock::now();
+                solver.reset(start, goal);
+                auto t2 = Clock::now();
+
+                indexTime += std::chrono::duration<double>(t1 - t0).count();
+                searchTime += std::chrono::duration<double>(t2 - t1).count();
+                if ((int) path.size() != solver.getPathLength())
+                    mismatches++;
+            }
+            return mismatches;
+        };
+
+        double indexTime = 0;
+        double searchTime = 0;
+        int mismatches = compare(0, indexTime, searchTime);
+        std::cout << "  index:   " << indexTime / queries * 1000 << "ms per query" << std::endl;
+        std::cout << "  search:  " << searchTime / queries * 1000 << "ms per query" << std::endl;
+
+        // edit random walls, updating the index after each, and check the queries still agree with the edited maze
+        constexpr int edits = 200;
+        double updateTime = 0;
+        std::uint64_t value = rnd::hashCombine(seed, ~0ull);
+        for (int i = 0; i < edits; i++) {
+            value = rnd::hashCombine(value, i);
+            sf::Vector2u cell = randomCell(value, size);
+            Maze::Direction dir = (value & 1) ? Maze::Direction::Right : Maze::Direction::Down;
+            if ((dir == Maze::Direction::Right && (int) cell.y == size - 1) || (dir == Maze::Direction::Down && (int) cell.x == size - 1))
+                continue;
+
+            solver.toggleWall(cell.x, cell.y, dir);
+            auto t0 = Clock::now();
+            index.update(cell.x, cell.y, dir);
+            updateTime += std::chrono::duration<double>(Clock::now() - t0).count();
+        }
+        std::cout << "  update:  " << updateTime / edits * 1000 << "ms per edit" << std::endl;
+
+        indexTime = searchTime = 0;
+        mismatches += compare(1, indexTime, searchTime);
+        if (mismatches > 0)
+            std::cout << "  " << mismatches << " paths had a different length than the full search" << std::endl;
+
+        // the binary form from before the edits belongs to another maze now
+        if (copy.readBinary(binary.data(), binary.size()))
+            std::cout << "  the index of the maze before the edits loaded for the edited maze" << std::endl;
+    }
+}
@@ -0,0 +1,162 @@
+#ifndef PATH_INDEX_HPP
+#define PATH_INDEX_HPP
+
+#include "Maze.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MazeCache;
+
+// hierarchical pathfinding index (HPA*) for answering many shortest path queries on one big maze
+//
+// the maze is cut into square clusters, every passage that crosses a cluster border makes its two cells entrances and
+// each cluster caches the distances between its entrances (staying inside the cluster). a query searches inside the
+// start and goal clusters, then runs A* over the entrances only and finally fills in the cells between them with
+// small searches inside single clusters. because every border passage is an entrance the paths are still shortest
+//
+// a pair of entrances is only linked if the path between them doesn't pass another entrance (that path is already
+// covered by the two shorter links), which keeps the links per entrance to a handful instead of all of the cluster's
+//
+// queries reuse the index's scratch buffers so an index answers one query at a time
+class PathIndex {
+public:
+    // the index keeps a reference to the maze, call build before the first query
+    PathIndex(const Maze& maze, int clusterSize = 64);
+
+    // (re)builds every cluster, the clusters are split between threads
+    void build(int threads = 1);
+
+    // rebuilds the clusters on both sides of a wall, call after toggling it in the maze
+    void update(const int row, const int col, Maze::Direction dir);
+
+    // fills path with the cells from start to goal, returns false if the goal can't be reached (or the maze was edited
+    // without updating the index)
+    bool findPath(sf::Vector2u start, sf::Vector2u goal, std::vector<sf::Vector2u>& path);
+
+    // length of the shortest path in steps or -1 if the goal can't be reached, skips the refinement
+    std::int64_t getDistance(sf::Vector2u start, sf::Vector2u goal);
+
+    int getClusterSize() const;
+    std::size_t getEntranceCount() const;
+
+    // approximate number of bytes held by this index
+    std::size_t memoryUsage() const;
+
+    // appends the index in its binary form: "HPAI", then cluster size, rows, cols and cluster count as 32 bit unsigned
+    // integers and a hash of the maze's passages as a 64 bit unsigned integer, then per cluster the entrance and link counts and the entrance cells (row * cols + col) as 32 bit
+    // unsigned integers followed by the link offsets (entrances + 1) as 32 bit and the link targets and link lengths as
+    // 16 bit unsigned integers, everything in host byte order
+    void appendBinary(std::string& out) const;
+
+    // loads an index written by appendBinary for this maze, returns false (leaving the index alone) if the data
+    // isn't a valid index or was made for a different maze
+    bool readBinary(const char* data, const std::size_t size);
+
+private:
+    struct Cluster {
+        // entrance cells sorted by cell number, so the entrance on the far side of a border passage can be looked up
+        std::vector<std::uint32_t> entrances;
+
+        // links between entrances inside the cluster, the links of entrance i are offsets[i] to offsets[i + 1]
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint16_t> targets;
+        std::vector<std::uint16_t> lengths;
+    };
+
+    // buffers for searches inside one cluster, indexed by the cell's position inside the cluster
+    struct Scratch {
+        int left = 0;
+        int top = 0;
+        int width = 0;
+        int height = 0;
+
+        std::vector<std::uint8_t> exits;
+        std::vector<std::uint16_t> distances;
+        std::vector<std::uint16_t> queue;
+
+        // entrance number of every cell (or none) and whether the search reached a cell through another entrance
+        std::vector<std::uint16_t> entrances;
+        std::vector<std::uint8_t> passed;
+    };
+
+    // an entrance waiting in the abstract search, ordered by cost so far plus the estimate to the goal
+    struct Open {
+        std::uint64_t estimate;
+        std::uint32_t node;
+
+        bool operator>(const Open& other) const { return estimate > other.estimate; }
+    };
+
+    int getCluster(std::uint32_t cell) const;
+    sf::IntRect getBounds(int cluster) const;
+
+    // reads the passages of a cluster's cells without any that leave the cluster
+    void loadExits(int cluster, Scratch& scratch) const;
+
+    // breadth first search inside the cluster loaded into scratch, leaves the distance of every cell in
+    // scratch.distances (and if passing is set whether the path to it passes another entrance in scratch.passed)
+    void search(std::uint32_t cell, Scratch& scratch, bool passing = false) const;
+    int getLocal(std::uint32_t cell, const Scratch& scratch) const;
+
+    void buildCluster(int cluster, Scratch& scratch);
+
+    // the entrance index of a cell in a cluster, or -1 if it isn't an entrance
+    int findEntrance(int cluster, std::uint32_t cell) const;
+
+    // true if entering the cluster through the entrance leads nowhere but back out the same way
+    bool isDeadEnd(int cluster, int entrance) const;
+
+    // recomputes the global numbering of the entrances after a cluster changed
+    void number();
+
+    // A* over the entrances, leaves the parent of every entrance on the best path in parents, returns the distance
+    std::int64_t searchAbstract(sf::Vector2u start, sf::Vector2u goal);
+
+    // appends the cells after from up to and including to, both in the same cluster, returns false if to can't be
+    // reached from from inside the cluster
+    bool refine(int cluster, std::uint32_t from, std::uint32_t to, std::vector<sf::Vector2u>& path);
+
+    // hash of every passage of the maze, so a stored index is never used with a maze it wasn't built for
+    std::uint64_t hashMaze() const;
+
+    const Maze& maze;
+    int clusterSize;
+    int rows = 0;
+    int cols = 0;
+    int clusterRows = 0;
+    int clusterCols = 0;
+
+    std::vector<Cluster> clusters;
+
+    // first global entrance number of every cluster (plus the total at the end) and the cluster of every entrance
+    std::vector<std::uint32_t> firstEntrance;
+    std::vector<std::uint32_t> entranceCluster;
+    bool numbered = false;
+
+    // abstract search state, stamped so nothing has to be cleared between queries
+    std::vector<std::uint64_t> costs;
+    std::vector<std::uint32_t> parents;
+    std::vector<std::uint32_t> stamps;
+    std::uint32_t stamp = 0;
+    std::vector<Open> heap;
+
+    // last entrance before the goal on the best path, or noEntrance if the path stays inside one cluster
+    std::uint32_t lastEntrance = 0;
+
+    // distances from the start to the start cluster's entrances and from the goal cluster's entrances to the goal
+    std::vector<std::uint16_t> startDistances;
+    std::vector<std::uint16_t> goalDistances;
+
+    Scratch scratch;
+};
+
+namespace hpa {
+    // builds an index over a size x size sidewinder maze (or loads the maze and index from the cache) and compares
+    // random queries against full breadth first searches, then toggles random walls, updates the index and compares again
+    void benchmark(int size, int threads, std::uint64_t seed, MazeCache* cache = nullptr);
+}
+
+#endif /* PATH_INDEX_HPP */
@@ -0,0 +1,159 @@
+#include "Profiler.hpp"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace profiler {
+    // invisible namespace for "private" state
+    namespace {
+        // one chrome trace event, ph is 'X' (complete), 'i' (instant) or 'C' (counter)
+        struct Event {
+            const char* name;
+            char ph;
+            std::int64_t ts;
+            std::int64_t dur;
+            int tid;
+            std::uint64_t values[5];
+        };
+
+        // cap the trace of a run so a long run can't eat all the memory (about 64MB of events)
+        constexpr std::size_t maxEvents = 1 << 20;
+
+        const auto epoch = std::chrono::steady_clock::now();
+
+        // every thread records into its own buffer so timed scopes on several generator threads (race view) don't
+        // fight over one lock, the lock of a buffer is only ever contended while the trace is written
+        struct ThreadEvents {
+            int tid;
+            std::mutex mutex;
+            std::vector<Event> events;
+        };
+
+        // buffers outlive their threads so the trace still has the events of finished generators
+        std::mutex threadsMutex;
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+        std::atomic<std::size_t> eventCount {0};
+        std::atomic<std::size_t> droppedCount {0};
+        std::atomic<int> runCount {0};
+
+        std::int64_t micros(std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(t - epoch).count();
+        }
+
+        // small stable ids read better in the trace viewer than hashed thread ids
+        ThreadEvents& currentThread() {
+            thread_local ThreadEvents* local = nullptr;
+            if (!local) {
+                std::lock_guard<std::mutex> lock(threadsMutex);
+                threads.push_back(std::make_unique<ThreadEvents>());
+                threads.back()->tid = (int) threads.size();
+                local = threads.back().get();
+            }
+            return *local;
+        }
+
+        void push(Event e) {
+            if (eventCount.fetch_add(1, std::memory_order_relaxed) >= maxEvents) {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            ThreadEvents& thread = currentThread();
+            e.tid = thread.tid;
+            std::lock_guard<std::mutex> lock(thread.mutex);
+            thread.events.push_back(e);
+        }
+    }
+
+    // see header
+    void beginRun() {
+        counters.cellsCarved = 0;
+        counters.animationSteps = 0;
+        counters.wallToggles = 0;
+        counters.slotsPainted = 0;
+        counters.framesDrawn = 0;
+
+        // the trace is rewritten after every run, so it only has to hold the run that is starting
+        {
+            std::lock_guard<std::mutex> threadsLock(threadsMutex);
+            for (const auto& thread : threads) {
+                std::lock_guard<std::mutex> lock(thread->mutex);
+                thread->events.clear();
+            }
+            eventCount = 0;
+            droppedCount = 0;
+        }
+
+        runCount++;
+        push(Event {"run start", 'i', micros(std::chrono::steady_clock::now()), 0, 0, {}});
+    }
+
+    // see header
+    void endRun(std::ostream& os) {
+        Event e {"counters", 'C', micros(std::chrono::steady_clock::now()), 0, 0,
+                 {counters.cellsCarved, counters.animationSteps, counters.wallToggles, counters.slotsPainted, counters.framesDrawn}};
+
+        os << "Run " << runCount << " counters:"
+           << "\n  cells carved:    " << e.values[0]
+           << "\n  animation steps: " << e.values[1]
+           << "\n  wall toggles:    " << e.values[2]
+           << "\n  slots painted:   " << e.values[3]
+           << "\n  frames drawn:    " << e.values[4] << std::endl;
+
+        push(e);
+    }
+
+    // see header
+    void record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        std::int64_t ts = micros(start);
+        push(Event {name, 'X', ts, micros(end) - ts, 0, {}});
+    }
+
+    // see header
+    bool writeChromeTrace(const std::string& fileName) {
+        std::ofstream file(fileName);
+        if (!file) {
+            std::cout << "Could not open " << fileName << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> threadsLock(threadsMutex);
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (const auto& thread : threads) {
+            std::lock_guard<std::mutex> lock(thread->mutex);
+            for (const Event& e : thread->events) {
+                file << (first ? "" : ",\n") << "{\"name\":\"" << e.name << "\",\"ph\":\"" << e.ph << "\",\"ts\":" << e.ts
+                     << ",\"pid\":1,\"tid\":" << e.tid;
+                first = false;
+
+                switch (e.ph) {
+                    case 'X':
+                        file << ",\"dur\":" << e.dur;
+                        break;
+                    case 'i':
+                        file << ",\"s\":\"g\"";
+                        break;
+                    case 'C':
+                        file << ",\"args\":{\"cellsCarved\":" << e.values[0] << ",\"animationSteps\":" << e.values[1]
+                             << ",\"wallToggles\":" << e.values[2] << ",\"slotsPainted\":" << e.values[3]
+                             << ",\"framesDrawn\":" << e.values[4] << "}";
+                        break;
+                }
+                file << "}";
+            }
+        }
+
+        // a trace that went over the cap says so instead of silently missing its end
+        if (droppedCount > 0) {
+            file << (first ? "" : ",\n") << "{\"name\":\"dropped " << droppedCount << " events\",\"ph\":\"i\",\"ts\":"
+                 << micros(std::chrono::steady_clock::now()) << ",\"pid\":1,\"tid\":0,\"s\":\"g\"}";
+        }
+        file << "\n";
+        file << "],\"displayTimeUnit\":\"ms\"}\n";
+
+        return (bool) file;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// built in instrumentation for the hot paths
+// everything here is compiled out unless MAZE_PROFILING is defined (cmake -DMAZE_ENABLE_PROFILING=ON)
+namespace profiler {
+#ifdef MAZE_PROFILING
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    // counters for the current run, relaxed atomics because the generator runs on its own thread
+    struct Counters {
+        std::atomic<std::uint64_t> cellsCarved {0};
+        std::atomic<std::uint64_t> animationSteps {0};
+        std::atomic<std::uint64_t> wallToggles {0};
+        std::atomic<std::uint64_t> slotsPainted {0};
+        std::atomic<std::uint64_t> framesDrawn {0};
+    };
+
+    inline Counters counters;
+
+    // resets the counters, throws away the events of the previous run and marks the start of a new one in the trace
+    void beginRun();
+
+    // prints the counters of the current run and adds them to the trace
+    void endRun(std::ostream& os);
+
+    // records a complete event (used by ScopedTimer)
+    void record(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    // writes every event of the current run as chrome trace event json (open with chrome://tracing or ui.perfetto.dev),
+    // with a marker saying how many were dropped if the run went over the cap
+    bool writeChromeTrace(const std::string& fileName);
+
+    // times the enclosing scope, name must be a string literal
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(const char* name) : name(name), start(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() { record(name, start, std::chrono::steady_clock::now()); }
+
+    private:
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#ifdef MAZE_PROFILING
+    #define PROFILE_CONCAT_IMPL(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+    #define PROFILE_SCOPE(name) profiler::ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(name)
+    #define PROFILE_COUNT(counter, n) profiler::counters.counter.fetch_add((n), std::memory_order_relaxed)
+#else
+    #define PROFILE_SCOPE(name) ((void) 0)
+    #define PROFILE_COUNT(counter, n) ((void) 0)
+#endif
+
+#endif /* PROFILER_HPP */
@@ -0,0 +1,161 @@
+#include "RaceView.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// size of a single pane in the window
+constexpr int paneSize = 320;
+
+// gap between the panes
+constexpr int paneMargin = 8;
+
+// how often the steps per second in the title are refreshed
+constexpr auto titleInterval = std::chrono::milliseconds(500);
+
+RaceView::RaceView(const std::vector<MazeSolver::Algorithm>& algos, sf::Vector2u mazeSize, int delay, unsigned int seed) : delay(delay) {
+    // lay the panes out in a roughly square grid
+    int columns = (int) std::ceil(std::sqrt((double) algos.size()));
+    for (std::size_t i = 0; i < algos.size(); i++) {
+        panes.push_back(std::make_unique<Pane>(algos[i], mazeSize, seed));
+
+        Pane& pane = *panes.back();
+        pane.viewport = sf::IntRect((int) (i % columns) * paneSize + paneMargin, (int) (i / columns) * paneSize + paneMargin,
+                                    paneSize - paneMargin * 2, paneSize - paneMargin * 2);
+        pane.renderer.resize(pane.maze, pane.viewport);
+    }
+}
+
+void RaceView::launch(Pane& pane) {
+    Maze& maze = pane.maze;
+    MazeSolver& solver = pane.solver;
+    Renderer& renderer = pane.renderer;
+    sf::RenderWindow& window = pane.window;
+    int delay = this->delay;
+
+    switch (pane.algo) {
+    case MazeSolver::Algorithm::RecursiveBacktrack:
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::recursiveBacktrack, solver, maze, window, renderer, delay, (int) maze.getFirstActive().x, (int) maze.getFirstActive().y, Maze::Direction::None);
+        });
+        break;
+    case MazeSolver::Algorithm::GrowingTree:
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::growingTree, solver, maze, window, renderer, delay);
+        });
+        break;
+    case MazeSolver::Algorithm::Ellers:
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::ellers, solver, maze, window, renderer, delay);
+        });
+        break;
+    case MazeSolver::Algorithm::RecursiveDivision:
+        // division starts from an empty maze, so reset before the thread starts rather than racing the first frame
+        maze.removeWalls();
+        renderer.resize(maze, pane.viewport, sf::Color::White);
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::recursiveDivision, solver, maze, window, renderer, delay, 0, 0, maze.getSize().y - 1, maze.getSize().x - 1, solver.irand(0, 100) > 50 ? true : false);
+        });
+        break;
+    case MazeSolver::Algorithm::BinaryTree:
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::binaryTree, solver, maze, window, renderer, delay);
+        });
+        break;
+    case MazeSolver::Algorithm::Sidewinder:
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::sidewinder, solver, maze, window, renderer, delay);
+        });
+        break;
+    case MazeSolver::Algorithm::HuntAndKill:
+        pane.handle = std::async(std::launch::async, [&solver, &maze, &window, &renderer, delay]() {
+            start(&MazeSolver::huntAndKill, solver, maze, window, renderer, delay);
+        });
+        break;
+    }
+}
+
+void RaceView::updateTitle(sf::RenderWindow& window, double seconds) {
+    std::string title;
+    for (auto& pane : panes) {
+        std::uint64_t steps = pane->solver.getSteps();
+        if (!pane->done && seconds > 0) {
+            pane->stepsPerSecond = (steps - pane->lastSteps) / seconds;
+            pane->lastSteps = steps;
+        }
+
+        char text[96];
+        if (pane->done)
+            std::snprintf(text, sizeof(text), "%s: done in %.2fs", getAlgoName(pane->algo),
+                          std::chrono::duration<double>(pane->elapsed).count());
+        else std::snprintf(text, sizeof(text), "%s: %.0f steps/s", getAlgoName(pane->algo), pane->stepsPerSecond);
+
+        if (!title.empty())
+            title += " | ";
+        title += text;
+    }
+
+    window.setTitle(title);
+}
+
+void RaceView::run() {
+    int columns = (int) std::ceil(std::sqrt((double) panes.size()));
+    int rows = ((int) panes.size() + columns - 1) / columns;
+
+    sf::ContextSettings cs;
+    cs.antialiasingLevel = 0;
+    sf::RenderWindow window(sf::VideoMode(columns * paneSize, rows * paneSize), "Race", sf::Style::Default, cs);
+    window.setFramerateLimit(60);
+
+    // every pane goes into this array, it keeps its capacity between frames
+    sf::VertexArray vertices(sf::Triangles);
+
+    auto begin = Clock::now();
+    for (auto& pane : panes)
+        launch(*pane);
+
+    auto lastTitle = begin;
+    std::size_t doneCount = 0;
+    while (window.isOpen()) {
+        sf::Event e;
+        while (window.pollEvent(e)) {
+            if (e.type == sf::Event::Closed)
+                window.close();
+        }
+
+        // note when each pane finishes, the time includes the delay so compare panes with the same delay only
+        auto now = Clock::now();
+        bool finished = false;
+        for (auto& pane : panes) {
+            if (!pane->done && pane->handle.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                pane->done = true;
+                pane->elapsed = now - begin;
+                finished = true;
+                doneCount++;
+
+                std::cout << getAlgoName(pane->algo) << ": " << pane->solver.getSteps() << " steps in "
+                          << std::chrono::duration<double>(pane->elapsed).count() << "s" << std::endl;
+            }
+        }
+
+        if (now - lastTitle >= titleInterval && doneCount < panes.size()) {
+            updateTitle(window, std::chrono::duration<double>(now - lastTitle).count());
+            lastTitle = now;
+        }
+        else if (finished)
+            updateTitle(window, 0);
+
+        vertices.clear();
+        for (auto& pane : panes)
+            pane->renderer.appendTo(vertices);
+
+        window.clear(sf::Color::White);
+        window.draw(vertices);
+        window.display();
+    }
+
+    // let anything still running finish without the delay, the pane destructors wait for them
+    for (auto& pane : panes)
+        pane->solver.skipDelay();
+}
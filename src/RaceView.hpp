@@ -0,0 +1,62 @@
+#ifndef RACEVIEW_HPP
+#define RACEVIEW_HPP
+
+#include "Maze.hpp"
+#include "MazeSolver.hpp"
+#include "Render.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+// runs several algorithms side by side in one window, each on its own thread and its own maze made with the same
+// seed, so the difference in how much work they do is visible at a glance
+//
+// the generators never draw themselves (their windows are never opened so update only sleeps and counts steps),
+// the main thread collects every pane into one vertex array and draws it with a single draw call instead
+class RaceView {
+public:
+    RaceView(const std::vector<MazeSolver::Algorithm>& algos, sf::Vector2u mazeSize, int delay, unsigned int seed);
+
+    // opens the window and runs the race, returns once the window is closed
+    void run();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pane {
+        Pane(MazeSolver::Algorithm algo, sf::Vector2u mazeSize, unsigned int seed) : algo(algo), maze(mazeSize.x, mazeSize.y), solver(seed) {}
+
+        MazeSolver::Algorithm algo;
+        Maze maze;
+        MazeSolver solver;
+        Renderer renderer;
+        sf::IntRect viewport;
+
+        // headless window handed to the generator
+        sf::RenderWindow window;
+
+        // steps per second over the last title update
+        std::uint64_t lastSteps = 0;
+        double stepsPerSecond = 0;
+        Clock::duration elapsed {};
+        bool done = false;
+
+        // declared last so it's destroyed (and waited for) before anything the generator uses
+        std::future<void> handle;
+    };
+
+    // starts the pane's generator on its own thread
+    void launch(Pane& pane);
+
+    // shows the steps per second of every pane, or its time once it's done, in the window title
+    // seconds is the time since the last update, 0 keeps the previous rates
+    void updateTitle(sf::RenderWindow& window, double seconds);
+
+    int delay;
+    std::vector<std::unique_ptr<Pane>> panes;
+};
+
+#endif /* RACEVIEW_HPP */
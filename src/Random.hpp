@@ -0,0 +1,29 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+
+// small deterministic hashing helpers, std::hash and the standard engines' seeding aren't
+// guaranteed to be the same on every platform so anything derived from a world seed uses these
+namespace rnd {
+    // splitmix64 step, advances the state and returns a well mixed 64 bit value
+    inline std::uint64_t splitmix64(std::uint64_t& state) {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // mixes a value into a seed
+    inline std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value) {
+        std::uint64_t state = seed ^ (value * 0xD6E8FEB86659FD93ull);
+        return splitmix64(state);
+    }
+
+    // maps a random 64 bit value to [0, range) without a division
+    inline std::uint32_t bounded(std::uint64_t value, std::uint32_t range) {
+        return (std::uint32_t) (((value >> 32) * range) >> 32);
+    }
+}
+
+#endif /* RANDOM_HPP */
@@ -1,59 +1,70 @@
 #include "Render.hpp"
 #include "Maze.hpp"
+#include "Profiler.hpp"
+#include "TerminalView.hpp"
 #include <SFML/Graphics.hpp>
 
+#include <algorithm>
 #include <utility>
 
 constexpr int wallWidth = 8;
 
-sf::RectangleShape getShape(bool cell, int dim, sf::Vector2i location, sf::Vector2f position, sf::Color backgroundFill) {
-    sf::RectangleShape rs(sf::Vector2f(dim, dim));
-    rs.setFillColor(cell ? backgroundFill : sf::Color::Black);
-    rs.setPosition(position);
-
-    if (location.x % 2 == 0 || location.y % 2 == 0) {
-        float sizeX = (location.x % 2 == 0) ? dim / wallWidth : dim;
-        float sizeY = (location.y % 2 == 0) ? dim / wallWidth : dim;
-
-        rs.setSize(sf::Vector2f(sizeX, sizeY));
-    }
-
-    return rs;
+// writes the two triangles of a rectangle
+void setRect(sf::Vertex* quad, sf::Vector2f position, sf::Vector2f size, sf::Color fill) {
+    sf::Vector2f corners[4] = {position, position + sf::Vector2f(size.x, 0), position + size, position + sf::Vector2f(0, size.y)};
+    int order[6] = {0, 1, 2, 0, 2, 3};
+    for (int i = 0; i < 6; i++)
+        quad[i] = sf::Vertex(corners[order[i]], fill);
 }
 
 Renderer::Renderer(Maze& maze, const sf::IntRect& viewport) {
     resize(maze, viewport);
 }
 
+Renderer::Renderer() {}
+
 void Renderer::resize(Maze& maze, const sf::IntRect& viewport, sf::Color backgroundFill) {
-    shapes.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    vertices.clear();
+
+    this->maze = &maze;
+    slotCols = maze.cols * 2 + 1;
+
+    if (terminal) {
+        terminal->resize(maze.rows * 2 + 1, maze.cols * 2 + 1, backgroundFill);
+        for (int i = 0; i < maze.rows * 2 + 1; i++) {
+            for (int j = 0; j < maze.cols * 2 + 1; j++) {
+                if (isMasked(i, j))
+                    terminal->set(i, j, sf::Color::White);
+                else if (!maze.slot(i, j))
+                    terminal->set(i, j, sf::Color::Black);
+            }
+        }
+        return;
+    }
+
     int dim = std::min((int) ((float) viewport.width * wallWidth) / ((wallWidth + 1) * (float) maze.cols + 1),
                        (int) ((float) viewport.height * wallWidth) / ((wallWidth + 1) * (float) maze.rows + 1));
+    int thin = dim / wallWidth;
+
+    // walls and corners are thin on the side facing the neighbouring cells, center the whole grid in the viewport
+    int width = (maze.cols + 1) * thin + maze.cols * dim;
+    int height = (maze.rows + 1) * thin + maze.rows * dim;
+    sf::Vector2f offset((viewport.width - width) / 2.0f, (viewport.height - height) / 2.0f);
+
+    vertices.resize((std::size_t) (maze.rows * 2 + 1) * slotCols * 6);
     sf::Vector2f pos(viewport.left, viewport.top);
-    for (int i = 0; i < maze.grid.size(); i++) {
-        for (int j = 0; j < maze.grid[i].size(); j++) {
-            auto rs = getShape(maze.grid[i][j], dim, sf::Vector2i(j, i), pos, backgroundFill);
-            rs.setTextureRect(sf::IntRect(sf::Vector2i(i, j), sf::Vector2i(0, 0)));
-            pos.x += rs.getSize().x;
-            shapes.push_back(rs);
+    for (int i = 0; i < maze.rows * 2 + 1; i++) {
+        for (int j = 0; j < slotCols; j++) {
+            sf::Vector2f size((j % 2 == 0) ? thin : dim, (i % 2 == 0) ? thin : dim);
+            sf::Color fill = isMasked(i, j) ? sf::Color::White : (maze.slot(i, j) ? backgroundFill : sf::Color::Black);
+
+            setRect(&vertices[((std::size_t) i * slotCols + j) * 6], pos + offset, size, fill);
+            pos.x += size.x;
         }
-        pos.y += (i % 2 == 0) ? dim / wallWidth : dim;
+        pos.y += (i % 2 == 0) ? thin : dim;
         pos.x = viewport.left;
     }
-
-    
-    int maxX = 0;
-    int maxY = 0;
-    for (sf::RectangleShape& rs : shapes) {
-        if (rs.getPosition().x + rs.getSize().x > maxX)
-            maxX = rs.getPosition().x + rs.getSize().x;
-        if (rs.getPosition().y + rs.getSize().y > maxY)
-            maxY = rs.getPosition().y + rs.getSize().y;
-    }
-    
-    sf::Vector2f offset(viewport.left + viewport.width - maxX, viewport.top + viewport.height - maxY);
-    for (sf::RectangleShape& rs : shapes)
-        rs.setPosition(rs.getPosition() + offset / 2.0f);
 }
 
 void Renderer::resize(Maze& maze, const sf::IntRect& viewport) {
@@ -61,36 +72,128 @@ void Renderer::resize(Maze& maze, const sf::IntRect& viewport) {
 }
 
 void Renderer::draw(sf::RenderWindow& window) {
-    sf::VertexArray arr(sf::Triangles);
-    for (sf::RectangleShape& rs : shapes) {
-        for (int i = 0; i < 3; i++) {
-            sf::Vector2f pos = rs.getPoint(i) + rs.getPosition();
-            arr.append(sf::Vertex(pos, rs.getFillColor()));
-        }
-        for (int i = 0; i < 4; i++) {
-            if (i == 1) continue;
-            sf::Vector2f pos = rs.getPoint(i) + rs.getPosition();
-            arr.append(sf::Vertex(pos, rs.getFillColor()));
-        }
+    PROFILE_SCOPE("Renderer::draw");
+    PROFILE_COUNT(framesDrawn, 1);
+    std::lock_guard<std::mutex> lock(mutex);
+    window.draw(vertices);
+}
+
+void Renderer::appendTo(sf::VertexArray& vertices) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t count = this->vertices.getVertexCount();
+    if (count == 0)
+        return;
+
+    // one resize and one block copy rather than an append per vertex, so the generator isn't kept waiting on the
+    // lock (a vertex array keeps its vertices in one contiguous buffer, and a cleared one keeps its capacity)
+    std::size_t offset = vertices.getVertexCount();
+    vertices.resize(offset + count);
+    std::copy(&this->vertices[0], &this->vertices[0] + count, &vertices[offset]);
+}
+
+bool Renderer::findSlot(sf::Vector2f point, int& row, int& col) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (slotCols == 0 || vertices.getVertexCount() == 0)
+        return false;
+
+    // slots line up in rows and columns, so the first row and the first column are enough to search through
+    // (the first vertex of a slot is its top left corner and the third its bottom right one)
+    int slotRows = (int) (vertices.getVertexCount() / 6 / slotCols);
+    int low = 0;
+    int high = slotCols;
+    while (high - low > 1) {
+        int middle = (low + high) / 2;
+        if (vertices[(std::size_t) middle * 6].position.x <= point.x)
+            low = middle;
+        else high = middle;
+    }
+    col = low;
+
+    low = 0;
+    high = slotRows;
+    while (high - low > 1) {
+        int middle = (low + high) / 2;
+        if (vertices[(std::size_t) middle * slotCols * 6].position.y <= point.y)
+            low = middle;
+        else high = middle;
     }
+    row = low;
+
+    const sf::Vertex* slot = &vertices[((std::size_t) row * slotCols + col) * 6];
+    return point.x >= slot[0].position.x && point.x < slot[2].position.x &&
+           point.y >= slot[0].position.y && point.y < slot[2].position.y;
+}
+
+void Renderer::setColor(const int row, const int col, sf::Color fill) {
+    std::size_t slot = (std::size_t) row * slotCols + col;
+    if (row < 0 || col < 0 || col >= slotCols || slot * 6 >= vertices.getVertexCount())
+        return;
 
-    window.draw(arr);
+    PROFILE_COUNT(slotsPainted, 1);
+    for (int i = 0; i < 6; i++)
+        vertices[slot * 6 + i].color = fill;
+}
+
+sf::Color Renderer::getColor(const int row, const int col) {
+    std::size_t slot = (std::size_t) row * slotCols + col;
+    if (row < 0 || col < 0 || col >= slotCols || slot * 6 >= vertices.getVertexCount())
+        return sf::Color::Transparent;
+
+    return vertices[slot * 6].color;
 }
 
 void Renderer::toggleWall(const int row, const int col, sf::Color fill) {
-    for (sf::RectangleShape& rs : shapes)
-        if (rs.getTextureRect().left == row && rs.getTextureRect().top == col)
-            rs.setFillColor(fill);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isMasked(row, col))
+        return;
+    if (terminal)
+        terminal->set(row, col, fill);
+
+    setColor(row, col, fill);
 }
 
 void Renderer::toggleCell(const int row, const int col, sf::Color fill) {
-    for (sf::RectangleShape& rs : shapes)
-        if (rs.getTextureRect().left == row && rs.getTextureRect().top == col)
-            rs.setFillColor(fill);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isMasked(row, col))
+        return;
+    if (terminal)
+        terminal->set(row, col, fill);
+
+    setColor(row, col, fill);
 }
 
 void Renderer::toggleIf(const int row, const int col, sf::Color fill, sf::Color condition) {
-    for (sf::RectangleShape& rs : shapes)
-        if (rs.getTextureRect().left == row && rs.getTextureRect().top == col && rs.getFillColor() == condition)
-            rs.setFillColor(fill);
-}
\ No newline at end of file
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isMasked(row, col))
+        return;
+    if (terminal && terminal->get(row, col) == condition)
+        terminal->set(row, col, fill);
+
+    if (getColor(row, col) == condition)
+        setColor(row, col, fill);
+}
+
+void Renderer::attach(TerminalView* terminal) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->terminal = terminal;
+}
+
+void Renderer::present(bool force) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (terminal)
+        terminal->flush(force);
+}
+
+bool Renderer::isMasked(const int row, const int col) const {
+    if (!maze || !maze->hasMask() || row < 0 || col < 0 || row > maze->rows * 2 || col >= slotCols)
+        return false;
+
+    // straight from the mask words, a slot touches the one to four cells around it
+    for (int r = std::max(0, (row - 1) / 2); r <= std::min(maze->rows - 1, row / 2); r++) {
+        const std::uint64_t* active = maze->getMaskWords(r);
+        for (int c = std::max(0, (col - 1) / 2); c <= std::min(maze->cols - 1, col / 2); c++)
+            if ((active[c / 64] >> (c % 64)) & 1)
+                return false;
+    }
+    return true;
+}
@@ -2,23 +2,60 @@
 #define RENDER_HPP
 
 class Maze;
+class TerminalView;
 
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 
 class Renderer {
 public:
     Renderer(Maze& maze, const sf::IntRect& viewport);
 
+    // headless renderer without any shapes, every toggle is a no-op
+    Renderer();
+
     void draw(sf::RenderWindow& window);
+
+    // appends the triangles of every slot to vertices, so several renderers can share one draw call
+    void appendTo(sf::VertexArray& vertices);
+
+    // slot of the grid under a point in window coordinates, false if the point misses the maze
+    bool findSlot(sf::Vector2f point, int& row, int& col);
+
+    // resizing reuses the vertices of the previous maze, so it only allocates when the maze grows
     void resize(Maze& maze, const sf::IntRect& viewport, sf::Color backgroundFill);
     void resize(Maze& maze, const sf::IntRect& viewport);
     void toggleWall(const int row, const int col, sf::Color fill);
     void toggleCell(const int row, const int col, sf::Color fill);
     void toggleIf(const int row, const int col, sf::Color fill, sf::Color condition);
 
+    // sends every resize and toggle to the terminal instead, a renderer with a terminal doesn't build any shapes
+    // (attach before the first resize, nullptr detaches)
+    void attach(TerminalView* terminal);
+
+    // shows the changes since the last frame on the terminal if there is one (called by MazeSolver::update)
+    void present(bool force = false);
+
 private:
-    std::vector<sf::RectangleShape> shapes;
+    // two triangles for every slot of the maze's (rows * 2 + 1) x (cols * 2 + 1) grid in row major order, so a
+    // toggle finds its slot by index and a frame is drawn straight from here
+    sf::VertexArray vertices {sf::Triangles};
+    TerminalView* terminal = nullptr;
+
+    void setColor(const int row, const int col, sf::Color fill);
+    sf::Color getColor(const int row, const int col);
+
+    // the maze of the last resize, its mask decides which slots are left out
+    const Maze* maze = nullptr;
+    int slotCols = 0;
+
+    // true for slots that only touch cells outside the maze's mask, they stay white and ignore toggles
+    bool isMasked(const int row, const int col) const;
+
+    // the generator toggles slots on its own thread while another thread may be drawing them
+    std::mutex mutex;
 };
 
 #endif /* RENDER_HPP */
\ No newline at end of file
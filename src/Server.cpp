@@ -0,0 +1,366 @@
+#include "Server.hpp"
+#include "Interface.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <csignal>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+// requests that are still being worked on per connection before the connection stops reading more
+constexpr std::size_t maxPending = 256;
+
+// the largest maze each algorithm is allowed to generate, the recursive backtracker recurses once per cell
+// and growing tree is quadratic in the size of its frontier so they get much smaller limits
+static std::uint64_t getMaxCells(MazeSolver::Algorithm algo) {
+    switch (algo) {
+        case MazeSolver::Algorithm::RecursiveBacktrack:
+            return 1 << 16;
+        case MazeSolver::Algorithm::GrowingTree:
+            return 1 << 20;
+        case MazeSolver::Algorithm::Ellers:
+        case MazeSolver::Algorithm::RecursiveDivision:
+            return 1 << 24;
+        default:
+            return 1 << 30;
+    }
+}
+
+// the largest maze a response may hold, a binary maze is a quarter of a byte per cell but text takes around 15 bytes
+// per cell, building the graph up to 16 and solving 12, so those stay at a few hundred MB per request
+static std::uint64_t getMaxCells(bool binary, bool solve) {
+    return (binary && !solve) ? 1 << 30 : 1 << 24;
+}
+
+// longest request line a socket connection may send, a client that goes past it without a newline is hung up on
+constexpr std::size_t maxLineBytes = 4096;
+
+// room in front of the payload for "ok <bytes>\n"
+constexpr std::size_t headerRoom = 24;
+
+// written responses kept for reuse, at most one per worker (enough for none of them to allocate) and only up to
+// a size, so a single huge maze doesn't keep its memory forever
+constexpr std::size_t maxSpares = 64;
+constexpr std::size_t maxSpareBytes = 64 << 20;
+
+Server::Server(int workers, MazeCache* cache) : cache(cache) {
+    for (int i = 0; i < std::max(workers, 1); i++) {
+        this->workers.push_back(std::make_unique<Worker>());
+        threads.emplace_back(&Server::work, this, std::ref(*this->workers.back()));
+    }
+}
+
+Server::~Server() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_all();
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+std::future<Server::Response> Server::submit(const std::string& request) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(Task {request, {}});
+    auto response = tasks.back().response.get_future();
+    ready.notify_one();
+
+    return response;
+}
+
+void Server::work(Worker& worker) {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task.response.set_value(handle(worker, task.request));
+    }
+}
+
+std::string Server::takeBuffer() {
+    std::lock_guard<std::mutex> lock(spareMutex);
+    if (spares.empty())
+        return {};
+
+    std::string buffer = std::move(spares.back());
+    spares.pop_back();
+    return buffer;
+}
+
+void Server::recycle(std::string buffer) {
+    std::lock_guard<std::mutex> lock(spareMutex);
+    if (buffer.capacity() <= maxSpareBytes && spares.size() < std::min(maxSpares, workers.size()))
+        spares.push_back(std::move(buffer));
+}
+
+Server::Response Server::handle(Worker& worker, const std::string& request) {
+    char command[8];
+    char format[8];
+    int algoNumber;
+    long long rows;
+    long long cols;
+    unsigned long long seed;
+
+    if (std::sscanf(request.c_str(), "%7s %d %lld %lld %llu %7s", command, &algoNumber, &rows, &cols, &seed, format) != 6)
+        return {"err expected: gen|solve <algorithm> <rows> <cols> <seed> <format>\n"};
+
+    bool solve = std::strcmp(command, "solve") == 0;
+    if (!solve && std::strcmp(command, "gen") != 0)
+        return {"err unknown command " + std::string(command) + "\n"};
+
+    MazeSolver::Algorithm algo;
+    if (!ui::getAlgorithmFromNumber(algoNumber, algo))
+        return {"err unknown algorithm " + std::to_string(algoNumber) + "\n"};
+
+    bool text = std::strcmp(format, "text") == 0;
+    bool ascii = std::strcmp(format, "ascii") == 0;
+    bool graph = std::strcmp(format, "graph") == 0;
+    if (!text && !ascii && !graph && std::strcmp(format, "maze") != 0)
+        return {"err unknown format " + std::string(format) + "\n"};
+
+    std::uint64_t maxCells = std::min(getMaxCells(algo), getMaxCells(!text && !ascii && !graph, solve));
+    // each side is checked on its own first, a product of two huge sides could wrap around to something small
+    if (rows < 1 || cols < 1 || (std::uint64_t) rows > maxCells || (std::uint64_t) cols > maxCells ||
+        (std::uint64_t) rows * cols > maxCells)
+        return {"err size must be at least 1x1 and at most " + std::to_string(maxCells) + " cells for " + getAlgoName(algo) +
+                " as " + format + (solve ? " with a path" : "") + "\n"};
+
+    if (seed > 0xFFFFFFFFull)
+        return {"err seed must fit in 32 bits\n"};
+
+    // generate into the worker's own buffers, which only grow when a bigger maze comes along
+    Maze& maze = worker.maze;
+    if (!cache || !cache->load(algo, (int) rows, (int) cols, (std::uint32_t) seed, maze)) {
+        maze.resize((int) rows, (int) cols);
+        worker.solver.seed((unsigned int) seed);
+        worker.solver.generate(maze, algo);
+
+        if (cache)
+            cache->store(algo, (int) rows, (int) cols, (std::uint32_t) seed, maze);
+    }
+
+    std::string payload = takeBuffer();
+    payload.assign(headerRoom, ' ');
+    if (text || ascii) {
+        worker.exporter.setStyle(ascii ? TextExporter::Style::Ascii : TextExporter::Style::Unicode);
+        worker.exporter.append(payload, maze);
+    }
+    else if (graph) {
+        worker.graphExporter.clearKept();
+        worker.graphExporter.keep(sf::Vector2u(0, 0));
+        worker.graphExporter.keep(sf::Vector2u(rows - 1, cols - 1));
+        worker.graphExporter.append(payload, maze);
+    }
+    else maze.appendBinary(payload);
+
+    if (solve) {
+        worker.pathSolver.reset(sf::Vector2u(0, 0), sf::Vector2u(rows - 1, cols - 1));
+
+        // written straight from the solver's path
+        std::uint32_t length = (std::uint32_t) worker.pathSolver.getPathLength();
+        std::size_t offset = payload.size();
+        payload.resize(offset + sizeof(length) + (std::size_t) length * 2 * sizeof(std::uint32_t));
+        char* out = &payload[offset];
+        std::memcpy(out, &length, sizeof(length));
+        out += sizeof(length);
+        for (std::uint32_t i = 0; i < length; i++) {
+            sf::Vector2u cell = worker.pathSolver.getPathCell((int) i);
+            std::uint32_t pair[2] = {cell.x, cell.y};
+            std::memcpy(out, pair, sizeof(pair));
+            out += sizeof(pair);
+        }
+    }
+
+    std::string header = "ok " + std::to_string(payload.size() - headerRoom) + "\n";
+    std::size_t begin = headerRoom - header.size();
+    std::memcpy(&payload[begin], header.data(), header.size());
+
+    return {std::move(payload), begin};
+}
+
+void Server::serveConnection(const LineReader& readLine, const Writer& write) {
+    std::mutex pendingMutex;
+    std::condition_variable changed;
+    std::deque<std::future<Response>> pending;
+    bool done = false;
+    bool failed = false;
+
+    // writes the responses in request order as soon as each one is ready
+    std::thread writer([&]() {
+        while (true) {
+            std::future<Response> next;
+            {
+                std::unique_lock<std::mutex> lock(pendingMutex);
+                changed.wait(lock, [&]() { return done || !pending.empty(); });
+                if (pending.empty())
+                    return;
+
+                next = std::move(pending.front());
+                pending.pop_front();
+            }
+            changed.notify_all();
+
+            Response response = next.get();
+            if (!failed && !write(response.data.data() + response.begin, response.data.size() - response.begin))
+                failed = true;
+            recycle(std::move(response.data));
+        }
+    });
+
+    std::string line;
+    while (readLine(line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty())
+            continue;
+
+        auto response = submit(line);
+
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        changed.wait(lock, [&]() { return pending.size() < maxPending; });
+        pending.push_back(std::move(response));
+        changed.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        done = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
+
+void Server::serve(std::istream& in, std::ostream& out) {
+    serveConnection([&](std::string& line) { return (bool) std::getline(in, line); },
+                    [&](const char* data, std::size_t size) {
+                        out.write(data, size);
+                        out.flush();
+                        return (bool) out;
+                    });
+}
+
+#ifndef _WIN32
+bool Server::serveSocket(const std::string& path) {
+    // a client hanging up mid response should only end that connection
+    std::signal(SIGPIPE, SIG_IGN);
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path " << path << " is too long" << std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+        if (listener >= 0)
+            close(listener);
+        return false;
+    }
+
+    // the thread of every connection that was open at the last accept, with a flag it sets once it's done
+    struct Connection {
+        std::thread thread;
+        std::unique_ptr<std::atomic<bool>> done;
+    };
+    std::vector<Connection> connections;
+
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "Could not accept a connection: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        // join the connections that have hung up since, so only the open ones hold on to a thread
+        for (std::size_t i = 0; i < connections.size();) {
+            if (*connections[i].done) {
+                connections[i].thread.join();
+                connections[i] = std::move(connections.back());
+                connections.pop_back();
+            }
+            else i++;
+        }
+
+        connections.push_back(Connection {{}, std::make_unique<std::atomic<bool>>(false)});
+        std::atomic<bool>* done = connections.back().done.get();
+        connections.back().thread = std::thread([this, fd, done]() {
+            std::string buffer;
+            std::size_t begin = 0;
+            char chunk[1 << 16];
+
+            auto readLine = [&](std::string& line) {
+                while (true) {
+                    std::size_t newline = buffer.find('\n', begin);
+                    if (newline != std::string::npos) {
+                        line.assign(buffer, begin, newline - begin);
+                        begin = newline + 1;
+                        return true;
+                    }
+
+                    // drop the lines that were already handed out before reading more
+                    buffer.erase(0, begin);
+                    begin = 0;
+                    if (buffer.size() > maxLineBytes)
+                        return false;
+
+                    ssize_t count = read(fd, chunk, sizeof(chunk));
+                    if (count <= 0)
+                        return false;
+                    buffer.append(chunk, count);
+                }
+            };
+
+            auto write = [fd](const char* data, std::size_t size) {
+                std::size_t sent = 0;
+                while (sent < size) {
+                    ssize_t count = send(fd, data + sent, size - sent, 0);
+                    if (count < 0 && errno == EINTR)
+                        continue;
+                    if (count <= 0)
+                        return false;
+                    sent += count;
+                }
+                return true;
+            };
+
+            serveConnection(readLine, write);
+            close(fd);
+            *done = true;
+        });
+    }
+
+    for (Connection& connection : connections)
+        connection.thread.join();
+    close(listener);
+
+    return false;
+}
+#else
+bool Server::serveSocket(const std::string& path) {
+    std::cerr << "Unix domain sockets aren't supported on this platform, use --serve instead" << std::endl;
+    return false;
+}
+#endif
@@ -0,0 +1,103 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "GraphExport.hpp"
+#include "IncrementalSolver.hpp"
+#include "Maze.hpp"
+#include "MazeCache.hpp"
+#include "MazeSolver.hpp"
+#include "TextExport.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// long running generation service so tools don't have to start the program (and open a window) for every maze
+//
+// requests are one line each:
+//   gen <algorithm> <rows> <cols> <seed> <format>
+//   solve <algorithm> <rows> <cols> <seed> <format>
+// algorithm uses the run.dat numbers (1 to 7) and format is one of
+//   maze   the binary maze (see Maze::appendBinary)
+//   graph  the corridor contracted graph (see GraphExporter::append), the top left and bottom right cells are always nodes
+//   text   unicode box drawing text
+//   ascii  +--+ ascii art text
+// solve also appends the path from the top left to the bottom right cell: the number of cells as a 32 bit unsigned
+// integer followed by a (row, col) pair of 32 bit unsigned integers per cell
+//
+// sizes are limited by the algorithm and by the format (text, graphs and paths take far more memory per cell than the
+// binary maze), a request over the limit gets an error saying what the limit is
+//
+// every response is "ok <bytes>\n" followed by exactly that many bytes, or "err <message>\n"
+// responses come back in the same order as the requests even though they are handled by a pool of workers
+// with a cache the mazes come from disk whenever the same maze was asked for before instead of being generated again
+class Server {
+public:
+    Server(int workers, MazeCache* cache = nullptr);
+    ~Server();
+
+    // serves requests until the input stream closes
+    void serve(std::istream& in, std::ostream& out);
+
+    // listens on a unix domain socket and serves every connection on its own thread (never returns unless setting up
+    // the socket fails), a connection that sends a line of more than a few KB without a newline is closed
+    bool serveSocket(const std::string& path);
+
+private:
+    // everything a worker keeps between requests so a request doesn't allocate a new maze each time
+    struct Worker {
+        Maze maze {1, 1};
+        MazeSolver solver {0};
+        IncrementalSolver pathSolver {maze, sf::Vector2u(0, 0), sf::Vector2u(0, 0)};
+        TextExporter exporter {TextExporter::Style::Unicode};
+        GraphExporter graphExporter;
+    };
+
+    // the bytes from begin to the end of data go out as the response, the payload is built right behind room for
+    // the header so the two never have to be copied into one string (begin is 0 for errors)
+    struct Response {
+        std::string data;
+        std::size_t begin = 0;
+    };
+
+    struct Task {
+        std::string request;
+        std::promise<Response> response;
+    };
+
+    using LineReader = std::function<bool(std::string& line)>;
+    using Writer = std::function<bool(const char* data, std::size_t size)>;
+
+    // reads requests until readLine fails, writing the responses in order on a second thread
+    void serveConnection(const LineReader& readLine, const Writer& write);
+
+    std::future<Response> submit(const std::string& request);
+    void work(Worker& worker);
+    Response handle(Worker& worker, const std::string& request);
+
+    // buffers of responses that have been written, handed to later responses so they don't allocate again
+    std::string takeBuffer();
+    void recycle(std::string buffer);
+
+    std::mutex spareMutex;
+    std::vector<std::string> spares;
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Task> tasks;
+    bool stopping = false;
+
+    MazeCache* cache;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+};
+
+#endif /* SERVER_HPP */
@@ -0,0 +1,189 @@
+#include "TerminalView.hpp"
+
+#include <algorithm>
+
+// minimum time between two frames, anything faster only costs bandwidth
+constexpr auto frameInterval = std::chrono::milliseconds(33);
+
+// colour of the missing lower half of the last character row when the grid has an odd height, and the colour state
+// at the start of a frame (matches no real colour so the first character always sets both)
+constexpr std::uint32_t none = 0xFF000000;
+
+// invisible namespace for "private" functions
+namespace {
+    void appendNumber(std::string& out, unsigned int number) {
+        char digits[10];
+        int count = 0;
+        do {
+            digits[count++] = (char) ('0' + number % 10);
+            number /= 10;
+        } while (number > 0);
+
+        while (count > 0)
+            out += digits[--count];
+    }
+
+    // moves the cursor to a character (escape sequences count from 1)
+    void appendMove(std::string& out, int row, int col) {
+        out += "\x1b[";
+        appendNumber(out, row + 1);
+        out += ';';
+        appendNumber(out, col + 1);
+        out += 'H';
+    }
+}
+
+TerminalView::TerminalView(std::FILE* out) : out(out) {}
+
+TerminalView::~TerminalView() {
+    finish();
+}
+
+std::uint32_t TerminalView::pack(sf::Color color) {
+    return ((std::uint32_t) color.r << 16) | ((std::uint32_t) color.g << 8) | color.b;
+}
+
+std::uint64_t TerminalView::getCharacter(std::size_t index) const {
+    std::size_t row = index / width * 2;
+    std::size_t col = index % width;
+
+    std::uint32_t lower = (int) row + 1 < height ? slots[(row + 1) * width + col] : none;
+    return ((std::uint64_t) slots[row * width + col] << 32) | lower;
+}
+
+void TerminalView::resize(const int height, const int width, sf::Color fill) {
+    this->height = height;
+    this->width = width;
+
+    std::size_t characters = (std::size_t) (height + 1) / 2 * width;
+    slots.assign((std::size_t) height * width, pack(fill));
+    drawn.assign(characters, ~0ull);
+    isDirty.assign(characters, 1);
+
+    dirty.resize(characters);
+    for (std::size_t i = 0; i < characters; i++)
+        dirty[i] = (std::uint32_t) i;
+
+    clearing = true;
+    finished = false;
+}
+
+void TerminalView::set(const int row, const int col, sf::Color fill) {
+    if (row < 0 || row >= height || col < 0 || col >= width)
+        return;
+
+    slots[(std::size_t) row * width + col] = pack(fill);
+
+    std::size_t index = (std::size_t) (row / 2) * width + col;
+    if (!isDirty[index]) {
+        isDirty[index] = 1;
+        dirty.push_back((std::uint32_t) index);
+    }
+}
+
+sf::Color TerminalView::get(const int row, const int col) const {
+    if (row < 0 || row >= height || col < 0 || col >= width)
+        return sf::Color::Black;
+
+    std::uint32_t color = slots[(std::size_t) row * width + col];
+    return sf::Color((sf::Uint8) (color >> 16), (sf::Uint8) (color >> 8), (sf::Uint8) color);
+}
+
+void TerminalView::appendColor(bool foreground, std::uint32_t color) {
+    if (color == none) {
+        buffer += foreground ? "\x1b[39m" : "\x1b[49m";
+        return;
+    }
+
+    buffer += foreground ? "\x1b[38;2;" : "\x1b[48;2;";
+    appendNumber(buffer, color >> 16);
+    buffer += ';';
+    appendNumber(buffer, (color >> 8) & 0xFF);
+    buffer += ';';
+    appendNumber(buffer, color & 0xFF);
+    buffer += 'm';
+}
+
+void TerminalView::flush(bool force) {
+    if (dirty.empty() && !clearing)
+        return;
+
+    auto now = Clock::now();
+    if (!force && now - lastFrame < frameInterval)
+        return;
+    lastFrame = now;
+
+    buffer.clear();
+    if (clearing) {
+        // hide the cursor while drawing and start from an empty screen
+        buffer += "\x1b[?25l\x1b[0m\x1b[2J";
+        clearing = false;
+    }
+
+    // in screen order, so runs of changed characters only need the one cursor move
+    std::sort(dirty.begin(), dirty.end());
+
+    foreground = none;
+    background = none;
+    std::uint32_t cursor = ~0u;
+    for (std::uint32_t index : dirty) {
+        isDirty[index] = 0;
+
+        std::uint64_t character = getCharacter(index);
+        if (drawn[index] == character)
+            continue;
+        drawn[index] = character;
+
+        if (index != cursor)
+            appendMove(buffer, (int) (index / width), (int) (index % width));
+
+        // the cursor moves on by itself except past the end of a line, where terminals differ
+        cursor = (index + 1) % width == 0 ? ~0u : index + 1;
+
+        std::uint32_t upper = (std::uint32_t) (character >> 32);
+        std::uint32_t lower = (std::uint32_t) character;
+
+        // a character that's one colour is a space, which only needs the background
+        if (upper == lower) {
+            if (background != lower)
+                appendColor(false, lower);
+            background = lower;
+            buffer += ' ';
+            continue;
+        }
+
+        if (foreground != upper)
+            appendColor(true, upper);
+        if (background != lower)
+            appendColor(false, lower);
+        foreground = upper;
+        background = lower;
+
+        // upper half block
+        buffer += "\xe2\x96\x80";
+    }
+    dirty.clear();
+
+    if (buffer.empty())
+        return;
+
+    // leave the terminal's colours alone for anything else that gets printed
+    buffer += "\x1b[0m";
+    std::fwrite(buffer.data(), 1, buffer.size(), out);
+    std::fflush(out);
+}
+
+void TerminalView::finish() {
+    if (finished)
+        return;
+
+    flush(true);
+
+    buffer.clear();
+    appendMove(buffer, (height + 1) / 2, 0);
+    buffer += "\x1b[?25h";
+    std::fwrite(buffer.data(), 1, buffer.size(), out);
+    std::fflush(out);
+
+    finished = true;
+}
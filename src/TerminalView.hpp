@@ -0,0 +1,70 @@
+#ifndef TERMINAL_VIEW_HPP
+#define TERMINAL_VIEW_HPP
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// draws the renderer's grid of cells, walls and corners in a terminal with ansi escape sequences, for hosts without
+// a display (see Renderer::attach)
+//
+// every character is an upper half block showing two slots of the grid above each other (the upper one as the
+// foreground colour, the lower one as the background), so the maze keeps its proportions. only characters that
+// changed since the last frame are written and a frame goes out as a single write
+//
+// not thread safe on its own, the renderer calls it under its lock
+class TerminalView {
+public:
+    TerminalView(std::FILE* out = stdout);
+
+    // moves the cursor below the maze
+    ~TerminalView();
+
+    // starts over with a height x width grid of slots all set to fill, the next frame clears the screen
+    void resize(const int height, const int width, sf::Color fill);
+
+    void set(const int row, const int col, sf::Color fill);
+    sf::Color get(const int row, const int col) const;
+
+    // writes the characters that changed since the last frame, frames closer together than the frame interval are
+    // skipped (the changes go out with the next one) unless forced
+    void flush(bool force = false);
+
+    // writes anything left and moves the cursor below the maze so normal output can follow
+    void finish();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // colours packed as 0xRRGGBB, a character packs its upper slot in the high half and its lower one in the low half
+    static std::uint32_t pack(sf::Color color);
+    std::uint64_t getCharacter(std::size_t index) const;
+
+    void appendColor(bool foreground, std::uint32_t color);
+
+    std::FILE* out;
+    int height = 0;
+    int width = 0;
+
+    std::vector<std::uint32_t> slots;
+
+    // what the terminal currently shows for every character and the characters that may differ from it
+    std::vector<std::uint64_t> drawn;
+    std::vector<std::uint32_t> dirty;
+    std::vector<std::uint8_t> isDirty;
+
+    bool clearing = false;
+    bool finished = true;
+    Clock::time_point lastFrame;
+
+    // colours set by the escape sequences written so far this frame
+    std::uint32_t foreground = 0;
+    std::uint32_t background = 0;
+
+    std::string buffer;
+};
+
+#endif /* TERMINAL_VIEW_HPP */
@@ -0,0 +1,170 @@
+#include "TextExport.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstring>
+
+// the buffer is handed to the stream once it grows past this
+constexpr std::size_t blockSize = 1 << 16;
+
+// a piece of text with its length worked out at compile time, so writing one doesn't need a strlen
+struct Glyph {
+    const char* text;
+    std::size_t length;
+};
+
+template <std::size_t N>
+constexpr Glyph glyph(const char (&text)[N]) {
+    return Glyph {text, N - 1};
+}
+
+static void put(char*& out, Glyph text) {
+    std::memcpy(out, text.text, text.length);
+    out += text.length;
+}
+
+// longest text a column of a border line can take (a junction and a horizontal line)
+constexpr std::size_t maxColumnBytes = 9;
+
+// box drawing junctions indexed by (up << 3) | (down << 2) | (left << 1) | right, written as utf-8 escapes
+// so the source doesn't depend on the compiler's source character set
+static constexpr Glyph junctions[16] = {
+    glyph(" "),            glyph("\xE2\x95\xB6"), glyph("\xE2\x95\xB4"), glyph("\xE2\x94\x80"),     //   ╶ ╴ ─
+    glyph("\xE2\x95\xB7"), glyph("\xE2\x94\x8C"), glyph("\xE2\x94\x90"), glyph("\xE2\x94\xAC"),     // ╷ ┌ ┐ ┬
+    glyph("\xE2\x95\xB5"), glyph("\xE2\x94\x94"), glyph("\xE2\x94\x98"), glyph("\xE2\x94\xB4"),     // ╵ └ ┘ ┴
+    glyph("\xE2\x94\x82"), glyph("\xE2\x94\x9C"), glyph("\xE2\x94\xA4"), glyph("\xE2\x94\xBC")      // │ ├ ┤ ┼
+};
+
+static constexpr Glyph horizontalLine = glyph("\xE2\x94\x80\xE2\x94\x80");
+static constexpr Glyph verticalLine = glyph("\xE2\x94\x82");
+static constexpr Glyph asciiLine = glyph("--");
+static constexpr Glyph gap = glyph("  ");
+
+TextExporter::TextExporter(Style style) : style(style) {
+    buffer.reserve(blockSize * 2);
+}
+
+void TextExporter::setStyle(Style style) {
+    this->style = style;
+}
+
+void TextExporter::write(std::ostream& os, const Maze& maze) {
+    for (int row = 0; row < (int) maze.getSize().x; row++)
+        writeRow(os, maze, row);
+    finish(os, maze);
+}
+
+void TextExporter::loadWalls(const Maze& maze, int row, std::vector<char>& horizontal, std::vector<char>& vertical) {
+    int cols = maze.getSize().y;
+    horizontal.resize(cols);
+    vertical.resize(cols + 1);
+
+    // straight from the passage words, the wall above a cell is the down passage of the cell above it and the wall
+    // right of a cell (one past it in vertical) is its right passage, the first row has the border above it
+    const std::uint64_t* above = row > 0 ? maze.getDownWords(row - 1) : nullptr;
+    const std::uint64_t* right = maze.getRightWords(row);
+    for (int word = 0; word < maze.getWordsPerRow(); word++) {
+        std::uint64_t up = above ? above[word] : 0;
+        std::uint64_t side = right[word];
+        char* h = horizontal.data() + word * 64;
+        char* v = vertical.data() + word * 64 + 1;
+
+        int count = std::min(64, cols - word * 64);
+        for (int bit = 0; bit < count; bit++) {
+            h[bit] = !((up >> bit) & 1);
+            v[bit] = !((side >> bit) & 1);
+        }
+    }
+
+    vertical[0] = vertical[cols] = true;
+}
+
+void TextExporter::append(std::string& out, const Maze& maze) {
+    for (int row = 0; row < (int) maze.getSize().x; row++)
+        appendRow(out, maze, row);
+    appendFooter(out, maze);
+}
+
+void TextExporter::writeRow(std::ostream& os, const Maze& maze, int row) {
+    appendRow(buffer, maze, row);
+    flush(os, false);
+}
+
+void TextExporter::finish(std::ostream& os, const Maze& maze) {
+    appendFooter(buffer, maze);
+    flush(os, true);
+}
+
+void TextExporter::appendRow(std::string& out, const Maze& maze, int row) {
+    int cols = maze.getSize().y;
+
+    // the walls of the previous row are the upper half of this row's border junctions
+    if (row == 0)
+        verticalAbove.assign(cols + 1, false);
+    else verticalAbove.swap(vertical);
+
+    loadWalls(maze, row, horizontal, vertical);
+    appendBorder(out, cols);
+    appendCells(out, cols);
+}
+
+void TextExporter::appendFooter(std::string& out, const Maze& maze) {
+    int cols = maze.getSize().y;
+
+    verticalAbove.swap(vertical);
+    vertical.assign(cols + 1, false);
+    horizontal.assign(cols, true);
+    appendBorder(out, cols);
+}
+
+void TextExporter::appendBorder(std::string& out, int cols) {
+    // make room for the longest possible line and write straight into it, then cut it down to what was written
+    std::size_t start = out.size();
+    out.resize(start + (cols + 1) * maxColumnBytes + 1);
+    char* end = &out[start];
+
+    for (int col = 0; col <= cols; col++) {
+        bool left = col > 0 && horizontal[col - 1];
+        bool right = col < cols && horizontal[col];
+
+        if (style == Style::Ascii)
+            *end++ = '+';
+        else put(end, junctions[(verticalAbove[col] << 3) | (vertical[col] << 2) | (left << 1) | right]);
+
+        if (col < cols) {
+            if (!right)
+                put(end, gap);
+            else if (style == Style::Ascii)
+                put(end, asciiLine);
+            else put(end, horizontalLine);
+        }
+    }
+    *end++ = '\n';
+    out.resize(end - out.data());
+}
+
+void TextExporter::appendCells(std::string& out, int cols) {
+    std::size_t start = out.size();
+    out.resize(start + (cols + 1) * maxColumnBytes + 1);
+    char* end = &out[start];
+
+    for (int col = 0; col <= cols; col++) {
+        if (!vertical[col])
+            *end++ = ' ';
+        else if (style == Style::Ascii)
+            *end++ = '|';
+        else put(end, verticalLine);
+
+        if (col < cols)
+            put(end, gap);
+    }
+    *end++ = '\n';
+    out.resize(end - out.data());
+}
+
+void TextExporter::flush(std::ostream& os, bool force) {
+    if (buffer.size() >= blockSize || (force && !buffer.empty())) {
+        os.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef TEXT_EXPORT_HPP
+#define TEXT_EXPORT_HPP
+
+#include "Maze.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// writes a maze as human readable text, either classic +--+ ascii art or unicode box drawing characters
+// whole rows are built in a reusable buffer which is handed to the stream in large blocks
+class TextExporter {
+public:
+    enum class Style {
+        Ascii,
+        Unicode
+    };
+
+    TextExporter(Style style);
+
+    void setStyle(Style style);
+
+    // writes the whole maze
+    void write(std::ostream& os, const Maze& maze);
+
+    // appends the whole maze to out instead of writing it to a stream
+    void append(std::string& out, const Maze& maze);
+
+    // streaming interface, rows have to be written in order and a row can be written as soon as
+    // nothing will change its walls anymore (in ellers that is as soon as the next row has been joined)
+    void writeRow(std::ostream& os, const Maze& maze, int row);
+
+    // writes the bottom border and flushes whatever is left in the buffer
+    void finish(std::ostream& os, const Maze& maze);
+
+private:
+    // wall flags for the horizontal line above the row and the vertical walls in the row
+    void loadWalls(const Maze& maze, int row, std::vector<char>& horizontal, std::vector<char>& vertical);
+
+    void appendRow(std::string& out, const Maze& maze, int row);
+    void appendFooter(std::string& out, const Maze& maze);
+    void appendBorder(std::string& out, int cols);
+    void appendCells(std::string& out, int cols);
+    void flush(std::ostream& os, bool force);
+
+    Style style;
+    std::string buffer;
+
+    // walls of the current row and of the row above it, kept so that every wall is only looked up once
+    std::vector<char> horizontal;
+    std::vector<char> vertical;
+    std::vector<char> verticalAbove;
+};
+
+#endif /* TEXT_EXPORT_HPP */
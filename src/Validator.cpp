@@ -0,0 +1,387 @@
+#include "Validator.hpp"
+#include "Bits.hpp"
+#include "IncrementalSolver.hpp"
+#include "Random.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace validator {
+    // invisible namespace for "private" functions
+    namespace {
+        std::uint32_t find(std::vector<std::uint32_t>& parent, std::uint32_t x) {
+            // path halving keeps the trees flat without a second pass
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        }
+
+        // returns false if the cells were already connected, meaning the passage between them closes a loop
+        bool unite(std::vector<std::uint32_t>& parent, std::uint32_t a, std::uint32_t b) {
+            a = find(parent, a);
+            b = find(parent, b);
+            if (a == b)
+                return false;
+
+            // hang the higher root under the lower one
+            if (a < b)
+                parent[b] = a;
+            else parent[a] = b;
+            return true;
+        }
+
+        // joins every passage that starts in rows [first, last), passages down out of the last row are only counted
+        void joinBand(const Maze& maze, std::vector<std::uint32_t>& parent, int first, int last, std::uint64_t& passages, bool& hasLoop) {
+            int cols = maze.getSize().y;
+            int words = maze.getWordsPerRow();
+
+            for (int row = first; row < last; row++) {
+                const std::uint64_t* right = maze.getRightWords(row);
+                const std::uint64_t* down = maze.getDownWords(row);
+
+                for (int word = 0; word < words; word++) {
+                    std::uint32_t base = (std::uint32_t) row * cols + word * 64;
+
+                    std::uint64_t set = right[word];
+                    passages += bits::popcount(set);
+                    while (set) {
+                        std::uint32_t cell = base + bits::countTrailingZeros(set);
+                        if (!unite(parent, cell, cell + 1))
+                            hasLoop = true;
+                        set &= set - 1;
+                    }
+
+                    set = down[word];
+                    passages += bits::popcount(set);
+                    if (row == last - 1)
+                        continue;
+                    while (set) {
+                        std::uint32_t cell = base + bits::countTrailingZeros(set);
+                        if (!unite(parent, cell, cell + cols))
+                            hasLoop = true;
+                        set &= set - 1;
+                    }
+                }
+            }
+        }
+
+        // paints one to four random dark discs on a light image with a pixel per cell, applyMask keeps the largest
+        // blob they make, so the mask comes out with ragged edges, holes and words that are only partly active
+        void drawBlobMask(sf::Image& image, int rows, int cols, std::uint64_t& state) {
+            image.create(cols, rows, sf::Color::White);
+
+            int blobs = 1 + rnd::bounded(rnd::splitmix64(state), 4);
+            for (int blob = 0; blob < blobs; blob++) {
+                int centerRow = rnd::bounded(rnd::splitmix64(state), rows);
+                int centerCol = rnd::bounded(rnd::splitmix64(state), cols);
+                int radius = 1 + rnd::bounded(rnd::splitmix64(state), std::max(rows, cols) / 2 + 1);
+
+                for (int row = std::max(0, centerRow - radius); row < std::min(rows, centerRow + radius + 1); row++) {
+                    for (int col = std::max(0, centerCol - radius); col < std::min(cols, centerCol + radius + 1); col++) {
+                        int dr = row - centerRow;
+                        int dc = col - centerCol;
+                        if (dr * dr + dc * dc <= radius * radius)
+                            image.setPixel(col, row, sf::Color::Black);
+                    }
+                }
+            }
+        }
+
+        // length of the shortest path in cells, 0 if there is none
+        int shortestPath(const Maze& maze, sf::Vector2u start, sf::Vector2u goal, std::vector<int>& distance, std::vector<int>& queue) {
+            int rows = maze.getSize().x;
+            int cols = maze.getSize().y;
+            distance.assign((std::size_t) rows * cols, 0);
+            queue.clear();
+
+            int first = start.x * cols + start.y;
+            distance[first] = 1;
+            queue.push_back(first);
+            for (std::size_t head = 0; head < queue.size(); head++) {
+                int cell = queue[head];
+                if (cell == (int) (goal.x * cols + goal.y))
+                    return distance[cell];
+
+                int row = cell / cols;
+                int col = cell % cols;
+                int next[4] = {cell - cols, cell + cols, cell - 1, cell + 1};
+                Maze::Direction dirs[4] = {Maze::Direction::Up, Maze::Direction::Down, Maze::Direction::Left, Maze::Direction::Right};
+                for (int d = 0; d < 4; d++) {
+                    if (maze.isOpen(row, col, dirs[d]) && distance[next[d]] == 0) {
+                        distance[next[d]] = distance[cell] + 1;
+                        queue.push_back(next[d]);
+                    }
+                }
+            }
+            return 0;
+        }
+
+        // true if path goes from start to goal through open passages without visiting a cell twice
+        bool isValidPath(const Maze& maze, const std::vector<sf::Vector2u>& path, sf::Vector2u start, sf::Vector2u goal, std::vector<int>& seen) {
+            if (path.empty() || path.front() != start || path.back() != goal)
+                return false;
+
+            int cols = maze.getSize().y;
+            seen.assign((std::size_t) maze.getSize().x * cols, 0);
+            for (std::size_t i = 0; i < path.size(); i++) {
+                if (seen[path[i].x * cols + path[i].y]++)
+                    return false;
+                if (i == 0)
+                    continue;
+
+                sf::Vector2u a = path[i - 1];
+                sf::Vector2u b = path[i];
+                bool open = (a.x == b.x && a.y + 1 == b.y && maze.isOpen(a.x, a.y, Maze::Direction::Right)) ||
+                            (a.x == b.x && b.y + 1 == a.y && maze.isOpen(a.x, a.y, Maze::Direction::Left)) ||
+                            (a.y == b.y && a.x + 1 == b.x && maze.isOpen(a.x, a.y, Maze::Direction::Down)) ||
+                            (a.y == b.y && b.x + 1 == a.x && maze.isOpen(a.x, a.y, Maze::Direction::Up));
+                if (!open)
+                    return false;
+            }
+            return true;
+        }
+    }
+
+    // see header
+    ValidationResult checkMaze(const Maze& maze, int threads) {
+        int rows = maze.getSize().x;
+        int cols = maze.getSize().y;
+        int words = maze.getWordsPerRow();
+
+        // only the active cells of a masked maze count
+        ValidationResult result;
+        result.cells = maze.getActiveCount();
+        if (result.cells == 0)
+            return result;
+
+        std::vector<std::uint32_t> parent((std::size_t) rows * cols);
+        for (std::uint32_t i = 0; i < parent.size(); i++)
+            parent[i] = i;
+
+        // each band only ever touches its own cells so the bands can be joined at the same time
+        threads = std::max(1, std::min(threads, rows));
+        int bandRows = (rows + threads - 1) / threads;
+        threads = (rows + bandRows - 1) / bandRows;
+
+        std::vector<std::uint64_t> passages(threads, 0);
+        std::vector<char> loops(threads, false);
+        auto band = [&](int t) {
+            bool hasLoop = false;
+            joinBand(maze, parent, t * bandRows, std::min(rows, (t + 1) * bandRows), passages[t], hasLoop);
+            loops[t] = hasLoop;
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; t++)
+            workers.emplace_back(band, t);
+        band(0);
+        for (std::thread& worker : workers)
+            worker.join();
+
+        for (int t = 0; t < threads; t++) {
+            result.passages += passages[t];
+            result.hasLoop = result.hasLoop || loops[t];
+        }
+
+        // stitch the bands together through the passages leaving the last row of each band
+        for (int row = bandRows - 1; row < rows - 1; row += bandRows) {
+            const std::uint64_t* down = maze.getDownWords(row);
+            for (int word = 0; word < words; word++) {
+                std::uint64_t set = down[word];
+                while (set) {
+                    std::uint32_t cell = (std::uint32_t) row * cols + word * 64 + bits::countTrailingZeros(set);
+                    if (!unite(parent, cell, cell + cols))
+                        result.hasLoop = true;
+                    set &= set - 1;
+                }
+            }
+        }
+
+        for (std::uint32_t i = 0; i < parent.size(); i++)
+            if (parent[i] == i && maze.isActive(i / cols, i % cols))
+                result.components++;
+
+        return result;
+    }
+
+    // see header
+    std::uint64_t stress(const std::vector<MazeSolver::Algorithm>& algos, std::uint64_t iterations, int minSize, int maxSize, int threads, std::uint64_t seed) {
+        // how often the multithreaded check is compared with the single threaded one
+        constexpr std::uint64_t bandedEvery = 16;
+        // how often a maze is generated inside a random mask instead of filling its whole grid
+        constexpr std::uint32_t maskedEvery = 4;
+
+        std::atomic<std::uint64_t> failures {0};
+        std::atomic<std::uint64_t> masked {0};
+        std::atomic<std::uint64_t> done {0};
+        std::mutex printMutex;
+
+        threads = std::max(threads, 1);
+        maxSize = std::max(minSize, maxSize);
+
+        auto worker = [&](int t) {
+            // every thread reuses one maze and one solver for all of its iterations
+            Maze maze(1, 1);
+            MazeSolver solver(0);
+            sf::Image mask;
+
+            for (std::uint64_t i = t; i < iterations; i += threads) {
+                // everything about an iteration comes from its index so a failure can be reproduced on its own
+                std::uint64_t state = rnd::hashCombine(seed, i);
+                unsigned int mazeSeed = (unsigned int) rnd::splitmix64(state);
+                int rows = minSize + rnd::bounded(rnd::splitmix64(state), maxSize - minSize + 1);
+                int cols = minSize + rnd::bounded(rnd::splitmix64(state), maxSize - minSize + 1);
+                MazeSolver::Algorithm algo = algos[i % algos.size()];
+
+                // a masked maze only has to be perfect over its active cells, checkMaze counts a passage leading out
+                // of the mask as an extra one so a generator (or fitToMask) that leaks past the edge fails as a loop
+                maze.resize(rows, cols);
+                bool isMasked = false;
+                if (rnd::bounded(rnd::splitmix64(state), maskedEvery) == 0) {
+                    drawBlobMask(mask, rows, cols, state);
+                    isMasked = maze.applyMask(mask);
+                    if (isMasked)
+                        masked++;
+                }
+                solver.seed(mazeSeed);
+                solver.generate(maze, algo);
+
+                ValidationResult result = checkMaze(maze, 1);
+                if (!result.isPerfect()) {
+                    failures++;
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    std::cout << "FAIL " << getAlgoName(algo) << " seed " << mazeSeed << " size " << rows << "x" << cols;
+                    if (isMasked)
+                        std::cout << " masked (iteration " << i << " of seed " << seed << ")";
+                    std::cout << ": " << result.passages << " passages for " << result.cells << " cells, "
+                              << result.components << " components" << (result.hasLoop ? ", has a loop" : "") << std::endl;
+                }
+
+                // the stress threads already keep every core busy, so only every so often are the rows also split into
+                // bands to check that stitching the bands together gives the same answer as joining them in one go
+                if (i % bandedEvery == 0 && rows >= 4) {
+                    int bands = 2 + (int) (i / bandedEvery % 7);
+                    ValidationResult banded = checkMaze(maze, bands);
+                    if (banded.cells != result.cells || banded.passages != result.passages ||
+                        banded.components != result.components || banded.hasLoop != result.hasLoop) {
+                        failures++;
+                        std::lock_guard<std::mutex> lock(printMutex);
+                        std::cout << "FAIL validator on " << bands << " threads for " << getAlgoName(algo) << " seed " << mazeSeed
+                                  << " size " << rows << "x" << cols << (isMasked ? " masked" : "") << ": " << banded.passages << " passages, " << banded.components
+                                  << " components" << (banded.hasLoop ? ", has a loop" : "") << " instead of " << result.passages
+                                  << " passages, " << result.components << " components" << (result.hasLoop ? ", has a loop" : "") << std::endl;
+                    }
+                }
+
+                std::uint64_t count = ++done;
+                if (count % 100000 == 0) {
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    std::cout << count << " / " << iterations << " mazes checked, " << failures << " failures" << std::endl;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; t++)
+            workers.emplace_back(worker, t);
+        worker(0);
+        for (std::thread& w : workers)
+            w.join();
+
+        std::cout << done << " mazes checked (" << masked << " masked), " << failures << " failures" << std::endl;
+        return failures;
+    }
+
+    // see header
+    std::uint64_t stressSolver(const std::vector<MazeSolver::Algorithm>& algos, std::uint64_t iterations, int maxSize, int threads, std::uint64_t seed) {
+        // toggles per maze, enough for the path to be cut, repaired and shortened many times over
+        constexpr int toggles = 200;
+
+        std::atomic<std::uint64_t> failures {0};
+        std::atomic<std::uint64_t> fullSolves {0};
+        std::mutex printMutex;
+
+        threads = std::max(threads, 1);
+        maxSize = std::max(maxSize, 2);
+
+        auto worker = [&](int t) {
+            Maze maze(1, 1);
+            MazeSolver solver(0);
+            IncrementalSolver pathSolver(maze, sf::Vector2u(0, 0), sf::Vector2u(0, 0));
+            std::vector<int> distance;
+            std::vector<int> queue;
+
+            for (std::uint64_t i = t; i < iterations; i += threads) {
+                std::uint64_t state = rnd::hashCombine(seed, i);
+                unsigned int mazeSeed = (unsigned int) rnd::splitmix64(state);
+                int rows = 2 + rnd::bounded(rnd::splitmix64(state), maxSize - 1);
+                int cols = 2 + rnd::bounded(rnd::splitmix64(state), maxSize - 1);
+                MazeSolver::Algorithm algo = algos[i % algos.size()];
+
+                maze.resize(rows, cols);
+                solver.seed(mazeSeed);
+                solver.generate(maze, algo);
+
+                // small budgets now and then so the fall back to a full search gets its share of the edits too
+                sf::Vector2u start(0, 0);
+                sf::Vector2u goal(rows - 1, cols - 1);
+                pathSolver.setRepairBudget(i % 4 == 0 ? 8 : 4096);
+                pathSolver.reset(start, goal);
+                int solvesBefore = pathSolver.getFullSolves();
+
+                for (int edit = 0; edit < toggles; edit++) {
+                    int row;
+                    int col;
+                    Maze::Direction dir;
+                    std::vector<sf::Vector2u> path = pathSolver.getPath();
+                    if (path.size() > 1 && rnd::splitmix64(state) % 2 == 0) {
+                        // cut the path somewhere
+                        std::size_t at = rnd::bounded(rnd::splitmix64(state), (std::uint32_t) path.size() - 1);
+                        sf::Vector2u a = path[at];
+                        sf::Vector2u b = path[at + 1];
+                        row = a.x;
+                        col = a.y;
+                        dir = (a.x == b.x) ? (a.y < b.y ? Maze::Direction::Right : Maze::Direction::Left)
+                                           : (a.x < b.x ? Maze::Direction::Down : Maze::Direction::Up);
+                    }
+                    else {
+                        row = rnd::bounded(rnd::splitmix64(state), rows);
+                        col = rnd::bounded(rnd::splitmix64(state), cols);
+                        dir = (rnd::splitmix64(state) % 2 == 0) ? Maze::Direction::Right : Maze::Direction::Down;
+                    }
+                    pathSolver.toggleWall(row, col, dir);
+
+                    int shortest = shortestPath(maze, start, goal, distance, queue);
+                    path = pathSolver.getPath();
+                    bool ok = (shortest > 0) == pathSolver.isConnected() &&
+                              (shortest == 0 ? path.empty() : isValidPath(maze, path, start, goal, queue) && (int) path.size() >= shortest);
+                    if (!ok) {
+                        failures++;
+                        std::lock_guard<std::mutex> lock(printMutex);
+                        std::cout << "FAIL incremental solver on " << getAlgoName(algo) << " seed " << mazeSeed << " size " << rows << "x" << cols
+                                  << " after " << edit + 1 << " toggles: path of " << path.size() << " cells, shortest is " << shortest << std::endl;
+                        break;
+                    }
+                }
+
+                fullSolves += pathSolver.getFullSolves() - solvesBefore;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; t++)
+            workers.emplace_back(worker, t);
+        worker(0);
+        for (std::thread& w : workers)
+            w.join();
+
+        std::cout << iterations * toggles << " wall toggles checked against full searches (" << fullSolves << " fell back to one), "
+                  << failures << " failures" << std::endl;
+        return failures;
+    }
+}
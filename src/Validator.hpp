@@ -0,0 +1,42 @@
+#ifndef VALIDATOR_HPP
+#define VALIDATOR_HPP
+
+#include "Maze.hpp"
+#include "MazeSolver.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// result of checking a maze, a perfect maze is a spanning tree of its cells:
+// everything is reachable (one component) and there are no loops (exactly cells - 1 passages)
+// on masked mazes only the active cells count, a passage into a masked out cell shows up as an extra passage
+struct ValidationResult {
+    std::uint64_t cells = 0;
+    std::uint64_t passages = 0;
+    std::uint64_t components = 0;
+    bool hasLoop = false;
+
+    bool isPerfect() const {
+        return components == 1 && !hasLoop && passages + 1 == cells;
+    }
+};
+
+namespace validator {
+    // counts passages and runs a union find over the passage bitmaps, rows are split into bands that
+    // are joined on their own threads before the bands are stitched together
+    ValidationResult checkMaze(const Maze& maze, int threads);
+
+    // generates iterations mazes with random seeds and sizes (cycling through algos) on every thread and checks
+    // that each one is perfect (every 16th one is also checked on 2 to 8 threads, which has to agree), about every 4th
+    // one is grown inside a random blob mask and only has to be perfect over its active cells, failures are printed
+    // with everything needed to reproduce them
+    // returns the number of failures
+    std::uint64_t stress(const std::vector<MazeSolver::Algorithm>& algos, std::uint64_t iterations, int minSize, int maxSize, int threads, std::uint64_t seed);
+
+    // toggles random walls (half of them on the current path) of iterations random mazes through an IncrementalSolver
+    // and checks after every toggle that its path is a real path from the start to the goal, and that it finds one
+    // exactly when a plain breadth first search does, returns the number of failures
+    std::uint64_t stressSolver(const std::vector<MazeSolver::Algorithm>& algos, std::uint64_t iterations, int maxSize, int threads, std::uint64_t seed);
+}
+
+#endif /* VALIDATOR_HPP */
@@ -0,0 +1,241 @@
+#include "World.hpp"
+#include "Random.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <iterator>
+
+// rounds towards negative infinity so that negative cells land in the right chunk
+static std::int64_t floorDiv(std::int64_t a, std::int64_t b) {
+    return (a >= 0) ? a / b : -((-a - 1) / b) - 1;
+}
+
+World::World(std::uint64_t seed, int chunkSize, std::size_t memoryBudget) : seed(seed), chunkSize(std::max(chunkSize, 1)) {
+    // measure an actual chunk rather than guessing at the maze's layout
+    std::size_t chunkBytes = Maze(this->chunkSize, this->chunkSize).memoryUsage() + sizeof(Chunk) + sizeof(Key) * 4;
+    capacity = std::max<std::size_t>(memoryBudget / chunkBytes, 1);
+    chunks.reserve(capacity);
+}
+
+World::Key World::makeKey(std::int32_t chunkRow, std::int32_t chunkCol) {
+    return ((Key) (std::uint32_t) chunkRow << 32) | (std::uint32_t) chunkCol;
+}
+
+int World::rightDoor(std::int32_t chunkRow, std::int32_t chunkCol) const {
+    return rnd::bounded(rnd::hashCombine(rnd::hashCombine(seed, makeKey(chunkRow, chunkCol)), 1), chunkSize);
+}
+
+int World::downDoor(std::int32_t chunkRow, std::int32_t chunkCol) const {
+    return rnd::bounded(rnd::hashCombine(rnd::hashCombine(seed, makeKey(chunkRow, chunkCol)), 2), chunkSize);
+}
+
+void World::generate(Maze& maze, std::int32_t chunkRow, std::int32_t chunkCol) {
+    std::uint64_t state = rnd::hashCombine(seed, makeKey(chunkRow, chunkCol));
+    std::uint32_t cells = (std::uint32_t) chunkSize * chunkSize;
+    visited.assign(cells, 0);
+    stack.clear();
+
+    std::uint32_t first = rnd::bounded(rnd::splitmix64(state), cells);
+    visited[first] = 1;
+    stack.push_back(first);
+
+    while (!stack.empty()) {
+        std::uint32_t cell = stack.back();
+        int row = (int) (cell / chunkSize);
+        int col = (int) (cell % chunkSize);
+
+        // unvisited neighbors in a fixed order so only the seed decides which one is taken
+        Maze::Direction options[4];
+        std::uint32_t next[4];
+        int count = 0;
+        if (row > 0 && !visited[cell - chunkSize]) {
+            options[count] = Maze::Direction::Up;
+            next[count++] = cell - chunkSize;
+        }
+        if (row < chunkSize - 1 && !visited[cell + chunkSize]) {
+            options[count] = Maze::Direction::Down;
+            next[count++] = cell + chunkSize;
+        }
+        if (col > 0 && !visited[cell - 1]) {
+            options[count] = Maze::Direction::Left;
+            next[count++] = cell - 1;
+        }
+        if (col < chunkSize - 1 && !visited[cell + 1]) {
+            options[count] = Maze::Direction::Right;
+            next[count++] = cell + 1;
+        }
+
+        // dead end, backtrack
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        int choice = (int) rnd::bounded(rnd::splitmix64(state), count);
+        maze.toggleWall(row, col, options[choice]);
+        visited[next[choice]] = 1;
+        stack.push_back(next[choice]);
+    }
+
+    generated++;
+}
+
+const Maze& World::getChunk(std::int32_t chunkRow, std::int32_t chunkCol) {
+    Key key = makeKey(chunkRow, chunkCol);
+
+    // already loaded, just move it to the front of the lru list
+    auto it = chunks.find(key);
+    if (it != chunks.end()) {
+        lru.splice(lru.begin(), lru, it->second.lru);
+        return it->second.maze;
+    }
+
+    if (chunks.size() >= capacity) {
+        // recycle the least recently used chunk, extracting the node keeps both the map node and the maze
+        auto node = chunks.extract(lru.back());
+        node.key() = key;
+        lru.back() = key;
+        lru.splice(lru.begin(), lru, std::prev(lru.end()));
+
+        Chunk& chunk = node.mapped();
+        chunk.lru = lru.begin();
+        chunk.maze.resize(chunkSize, chunkSize);
+        generate(chunk.maze, chunkRow, chunkCol);
+
+        return chunks.insert(std::move(node)).position->second.maze;
+    }
+
+    lru.push_front(key);
+    Chunk& chunk = chunks.emplace(key, Chunk {Maze(chunkSize, chunkSize), lru.begin()}).first->second;
+    generate(chunk.maze, chunkRow, chunkCol);
+
+    return chunk.maze;
+}
+
+bool World::isOpen(std::int64_t row, std::int64_t col, Maze::Direction dir) {
+    std::int32_t chunkRow = (std::int32_t) floorDiv(row, chunkSize);
+    std::int32_t chunkCol = (std::int32_t) floorDiv(col, chunkSize);
+    int localRow = (int) (row - (std::int64_t) chunkRow * chunkSize);
+    int localCol = (int) (col - (std::int64_t) chunkCol * chunkSize);
+
+    // crossing into another chunk only depends on the doors, so the neighbor never has to be generated
+    switch (dir) {
+        case Maze::Direction::Up:
+            if (localRow == 0)
+                return downDoor(chunkRow - 1, chunkCol) == localCol;
+            break;
+        case Maze::Direction::Down:
+            if (localRow == chunkSize - 1)
+                return downDoor(chunkRow, chunkCol) == localCol;
+            break;
+        case Maze::Direction::Left:
+            if (localCol == 0)
+                return rightDoor(chunkRow, chunkCol - 1) == localRow;
+            break;
+        case Maze::Direction::Right:
+            if (localCol == chunkSize - 1)
+                return rightDoor(chunkRow, chunkCol) == localRow;
+            break;
+        case Maze::Direction::None:
+            return false;
+    }
+
+    return getChunk(chunkRow, chunkCol).isOpen(localRow, localCol, dir);
+}
+
+void World::prefetch(std::int64_t row, std::int64_t col, int radius) {
+    std::int32_t chunkRow = (std::int32_t) floorDiv(row, chunkSize);
+    std::int32_t chunkCol = (std::int32_t) floorDiv(col, chunkSize);
+
+    // never prefetch more than fits, otherwise the prefetch would evict itself
+    while (radius > 0 && (std::size_t) (radius * 2 + 1) * (radius * 2 + 1) > capacity)
+        radius--;
+
+    for (int i = -radius; i <= radius; i++)
+        for (int j = -radius; j <= radius; j++)
+            getChunk(chunkRow + i, chunkCol + j);
+}
+
+int World::getChunkSize() const {
+    return chunkSize;
+}
+
+std::size_t World::getCapacity() const {
+    return capacity;
+}
+
+std::size_t World::loadedChunks() const {
+    return chunks.size();
+}
+
+std::uint64_t World::generatedChunks() const {
+    return generated;
+}
+
+namespace world {
+    // invisible namespace for "private" functions
+    namespace {
+        bool samePassages(const Maze& a, const Maze& b) {
+            if (a.getSize() != b.getSize())
+                return false;
+
+            for (int row = 0; row < (int) a.getSize().x; row++)
+                for (int word = 0; word < a.getWordsPerRow(); word++)
+                    if (a.getRightWords(row)[word] != b.getRightWords(row)[word] || a.getDownWords(row)[word] != b.getDownWords(row)[word])
+                        return false;
+            return true;
+        }
+
+        // fingerprint of a chunk, the same on every platform for the same seed
+        std::uint64_t hashPassages(const Maze& maze) {
+            std::uint64_t hash = 0;
+            for (int row = 0; row < (int) maze.getSize().x; row++)
+                for (int word = 0; word < maze.getWordsPerRow(); word++)
+                    hash = rnd::hashCombine(rnd::hashCombine(hash, maze.getRightWords(row)[word]), maze.getDownWords(row)[word]);
+            return hash;
+        }
+    }
+
+    // see header
+    bool explore(std::ostream& os, std::uint64_t seed, int chunkSize, int radius, TextExporter::Style style) {
+        chunkSize = std::max(chunkSize, 1);
+        int span = radius * 2 + 1;
+        World world(seed, chunkSize, (std::size_t) span * span * (Maze(chunkSize, chunkSize).memoryUsage() + 4096));
+
+        // room for a single chunk, so every chunk is evicted and generated again on the second pass
+        World small(seed, chunkSize, 0);
+
+        int mismatches = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = -radius; i <= radius; i++) {
+                for (int j = -radius; j <= radius; j++) {
+                    Maze expected = world.getChunk(i, j);
+                    if (!samePassages(expected, small.getChunk(i, j))) {
+                        os << "Chunk (" << i << ", " << j << ") differs on pass " << pass + 1 << std::endl;
+                        mismatches++;
+                    }
+                }
+            }
+        }
+
+        // stitch the chunks together, only the doors cross chunk borders
+        Maze area(span * chunkSize, span * chunkSize);
+        std::int64_t origin = -(std::int64_t) radius * chunkSize;
+        for (int row = 0; row < span * chunkSize; row++) {
+            for (int col = 0; col < span * chunkSize; col++) {
+                if (col + 1 < span * chunkSize && world.isOpen(origin + row, origin + col, Maze::Direction::Right))
+                    area.toggleWall(row, col, Maze::Direction::Right);
+                if (row + 1 < span * chunkSize && world.isOpen(origin + row, origin + col, Maze::Direction::Down))
+                    area.toggleWall(row, col, Maze::Direction::Down);
+            }
+        }
+        TextExporter(style).write(os, area);
+
+        os << "World seed " << seed << ", " << span << "x" << span << " chunks of " << chunkSize << "x" << chunkSize
+           << ", " << small.generatedChunks() << " generated with evictions, chunk (0, 0) hash "
+           << std::hex << hashPassages(world.getChunk(0, 0)) << std::dec << std::endl;
+        if (mismatches > 0)
+            os << mismatches << " chunks were not generated the same way twice" << std::endl;
+        return mismatches == 0;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef WORLD_HPP
+#define WORLD_HPP
+
+#include "Maze.hpp"
+#include "TextExport.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+// an unbounded maze made of square chunks, each chunk is generated the first time it is touched
+// from a seed derived from its coordinates so evicting a chunk and loading it again gives the same maze
+// (on every platform, chunks are carved with the rnd:: helpers instead of the standard engines)
+class World {
+public:
+    // memoryBudget is the number of bytes the loaded chunks may use (at least one chunk is always kept)
+    World(std::uint64_t seed, int chunkSize, std::size_t memoryBudget);
+
+    // true if there is a passage from the cell (global coordinates, may be negative) in the given direction
+    bool isOpen(std::int64_t row, std::int64_t col, Maze::Direction dir);
+
+    // returns the chunk, generating it if it isn't loaded (the reference is only valid until the next call)
+    const Maze& getChunk(std::int32_t chunkRow, std::int32_t chunkCol);
+
+    // loads every chunk within radius chunks of the cell, used to keep the area around a player warm
+    void prefetch(std::int64_t row, std::int64_t col, int radius);
+
+    int getChunkSize() const;
+    std::size_t getCapacity() const;
+    std::size_t loadedChunks() const;
+
+    // how many chunks have been generated so far (includes chunks generated again after eviction)
+    std::uint64_t generatedChunks() const;
+
+private:
+    using Key = std::uint64_t;
+
+    struct Chunk {
+        Maze maze;
+        std::list<Key>::iterator lru;
+    };
+
+    static Key makeKey(std::int32_t chunkRow, std::int32_t chunkCol);
+
+    // the doors are the single passages connecting a chunk to its right and bottom neighbors
+    int rightDoor(std::int32_t chunkRow, std::int32_t chunkCol) const;
+    int downDoor(std::int32_t chunkRow, std::int32_t chunkCol) const;
+
+    // carves the chunk with a recursive backtracker (on an explicit stack) driven by the chunk's seed
+    void generate(Maze& maze, std::int32_t chunkRow, std::int32_t chunkCol);
+
+    std::uint64_t seed;
+    int chunkSize;
+    std::size_t capacity;
+    std::uint64_t generated = 0;
+
+    // scratch for generate, kept between chunks
+    std::vector<std::uint32_t> stack;
+    std::vector<std::uint8_t> visited;
+
+    // front of the list is the most recently used chunk
+    std::list<Key> lru;
+    std::unordered_map<Key, Chunk> chunks;
+};
+
+namespace world {
+    // writes the chunks within radius of the origin as one maze and checks that every chunk comes out the same when
+    // it is generated again after an eviction and by a second world with the same seed, false on any difference
+    bool explore(std::ostream& os, std::uint64_t seed, int chunkSize, int radius, TextExporter::Style style);
+}
+
+#endif /* WORLD_HPP */